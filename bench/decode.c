@@ -0,0 +1,181 @@
+/**
+ * @file decode.c
+ * @author FR
+ *
+ * Micro benchmark of the Elias-delta and vbyte decoding of the reader.
+ * The Elias-delta codes are generated like the rules of a grammar with many small rules,
+ * which are decoded at every expansion of a non-terminal.
+ */
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <writer.h>
+#include <reader.h>
+
+// decoding bit by bit, as done by the reader before
+static uint64_t eliasdelta_bitwise(Reader* r) {
+	int len = 1;
+	int lenoflen = 0;
+
+	while(!reader_readbit(r))
+		lenoflen++;
+
+	int i;
+	for(i = 0; i < lenoflen; i++) {
+		len <<= 1;
+		if(reader_readbit(r))
+			len |= 1;
+	}
+
+	uint64_t n = 1;
+	for(i = 0; i < len - 1; i++) {
+		n <<= 1;
+		if(reader_readbit(r))
+			n |= 1;
+	}
+
+	return --n;
+}
+
+// decoding byte by byte, as done by the reader before
+static uint64_t vbyte_bytewise(Reader* r) {
+	uint64_t val = 0;
+	int shift = 0;
+
+	uint8_t nibble;
+	do {
+		nibble = reader_readbyte(r);
+
+		val |= ((uint64_t) (nibble & 0x7f)) << shift;
+		shift += 7;
+	} while((nibble & 0x80) == 0);
+
+	return val;
+}
+
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// writes the rules with the same structure as the grammar writer:
+// number of edges, followed by the label, rank and nodes of each edge
+static size_t write_rules(BitWriter* w, size_t rules, int labels) {
+	size_t codes = 0;
+	for(size_t i = 0; i < rules; i++) {
+		int edges = 2 + rand() % 3;
+		bitwriter_write_eliasdelta(w, edges);
+		codes++;
+
+		for(int j = 0; j < edges; j++) {
+			bitwriter_write_eliasdelta(w, rand() % labels);
+			bitwriter_write_eliasdelta(w, 3);
+			codes += 2;
+
+			for(int k = 0; k < 3; k++) {
+				bitwriter_write_eliasdelta(w, rand() % 12);
+				codes++;
+			}
+		}
+	}
+
+	return codes;
+}
+
+typedef uint64_t (*DecodeFunc)(Reader* r);
+
+static double run(FileReader* fr, DecodeFunc f, size_t codes, int rounds, uint64_t* sum) {
+	double start = now();
+
+	for(int i = 0; i < rounds; i++) {
+		Reader r;
+		reader_initf(fr, &r, 0);
+
+		for(size_t j = 0; j < codes; j++)
+			*sum += f(&r);
+	}
+
+	return (now() - start) / ((double) codes * rounds) * 1e9; // ns per code
+}
+
+int main(int argc, char** argv) {
+	size_t rules = argc > 1 ? strtoull(argv[1], NULL, 10) : 1000000;
+	int labels = argc > 2 ? atoi(argv[2]) : 1000;
+	int rounds = argc > 3 ? atoi(argv[3]) : 5;
+
+	char path[] = "/tmp/cgraph-bench-XXXXXX";
+	int fd = mkstemp(path);
+	if(fd < 0) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	srand(1);
+	size_t codes = write_rules(&w, rules, labels);
+
+	// the vbytes are written after the Elias-delta codes at a full byte
+	bitwriter_flush(&w);
+	FileOff off_vbyte = bitwriter_len(&w) / 8;
+
+	size_t vbytes = rules;
+	for(size_t i = 0; i < vbytes; i++)
+		bitwriter_write_vbyte(&w, rand() % (1 << (7 * (1 + i % 4))));
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	FileReader* fr = filereader_init(path, NULL);
+	if(!fr) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	uint64_t s1 = 0, s2 = 0;
+	double t1 = run(fr, eliasdelta_bitwise, codes, rounds, &s1);
+	double t2 = run(fr, reader_eliasdelta, codes, rounds, &s2);
+	if(s1 != s2)
+		fprintf(stderr, "Elias-delta decoders differ\n");
+
+	printf("elias-delta: %zu codes, bitwise %.2f ns, word %.2f ns, speedup %.2fx\n", codes, t1, t2, t1 / t2);
+
+	double t3 = 0, t4 = 0;
+	uint64_t s3 = 0, s4 = 0;
+	for(int i = 0; i < rounds; i++) {
+		Reader r;
+		reader_initf(fr, &r, off_vbyte);
+
+		double start = now();
+		for(size_t j = 0; j < vbytes; j++)
+			s3 += vbyte_bytewise(&r);
+		t3 += now() - start;
+
+		reader_initf(fr, &r, off_vbyte);
+
+		start = now();
+		for(size_t j = 0; j < vbytes; j++)
+			s4 += reader_vbyte(&r, NULL);
+		t4 += now() - start;
+	}
+	if(s3 != s4)
+		fprintf(stderr, "vbyte decoders differ\n");
+
+	t3 = t3 / ((double) vbytes * rounds) * 1e9;
+	t4 = t4 / ((double) vbytes * rounds) * 1e9;
+	printf("vbyte: %zu codes, bytewise %.2f ns, word %.2f ns, speedup %.2fx\n", vbytes, t3, t4, t3 / t4);
+
+	filereader_close(fr);
+	unlink(path);
+
+	return s1 == s2 && s3 == s4 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
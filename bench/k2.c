@@ -0,0 +1,321 @@
+/**
+ * @file k2.c
+ * @author FR
+ *
+ * Micro benchmark of the row iteration of the k2-tree, as done for every neighborhood query of a bound node.
+ * The iterator with a queue of allocated elements, as used before, is compared to the current iterator.
+ * Also the extraction of single columns is compared to the batched extraction of adjacent columns
+ * and the lookups of cells of the k2-tree with k = 2 are compared to the hybrid k2-tree.
+ * The region query is compared to the iteration of every row of the region.
+ */
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <writer.h>
+#include <reader.h>
+#include <ringqueue.h>
+#include <arith.h>
+#include <k2.h>
+#include <k2_writer.h>
+
+#define BATCH 8 // number of columns extracted together
+#define REGION 64 // number of rows and columns of a region
+
+// row iterator with a queue of allocated elements, as done by the reader before
+typedef struct {
+	uint64_t n;
+	uint64_t p;
+	uint64_t q;
+	int64_t x;
+} QueueElement;
+
+static bool leaf_get(K2Reader* k, uint64_t x) {
+	if(k->lw)
+		return (k->lw[x / 64] >> (x % 64)) & 1;
+
+	Reader l = k->l;
+	reader_bitpos(&l, x);
+	return reader_readbit(&l);
+}
+
+static void queue_iter_init(K2Reader* k, uint64_t p, RingQueue* queue) {
+	ringqueue_init(queue, MIN(k->height, 16));
+
+	QueueElement* l = malloc(sizeof(*l));
+	l->n = k->n;
+	l->x = -1;
+	l->p = p;
+	l->q = 0;
+	ringqueue_enqueue(queue, l);
+}
+
+static int queue_iter_next(K2Reader* k2, RingQueue* queue, uint64_t* v) {
+	int res = 0;
+	while(!ringqueue_empty(queue) && res != 1) {
+		QueueElement* l = ringqueue_dequeue(queue);
+		if(l->q >= k2->width)
+			goto loop_continue;
+
+		if(l->x >= (int64_t) bitsequence_reader_len(k2->t)) {
+			if(leaf_get(k2, l->x - bitsequence_reader_len(k2->t))) {
+				*v = l->q;
+				res = 1;
+			}
+		}
+		else if(l->x == -1 || bitsequence_reader_access(k2->t, l->x)) {
+			uint64_t k = k2->split[0];
+			uint64_t nnew = l->n / k;
+			uint64_t y = bitsequence_reader_rank1(k2->t, l->x) * (k * k) + k * (l->p / nnew);
+
+			for(int j = 0; j < k; j++) {
+				QueueElement* el = malloc(sizeof(*el));
+				el->n = nnew;
+				el->p = l->p % nnew;
+				el->q = l->q + nnew * j;
+				el->x = y + j;
+				ringqueue_enqueue(queue, el);
+			}
+		}
+
+loop_continue:
+		free(l);
+	}
+
+	return res;
+}
+
+static void queue_iter_finish(RingQueue* queue) {
+	while(!ringqueue_empty(queue))
+		free(ringqueue_dequeue(queue));
+	ringqueue_destroy(queue);
+}
+
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+	size_t nodes = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000;
+	size_t edges = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+	size_t rows = argc > 3 ? strtoull(argv[3], NULL, 10) : 10000;
+	int rounds = argc > 4 ? atoi(argv[4]) : 5;
+
+	char path[] = "/tmp/cgraph-bench-XXXXXX";
+	int fd = mkstemp(path);
+	if(fd < 0) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	K2Edge* e = malloc(edges * sizeof(*e));
+	K2Edge* eh = malloc(edges * sizeof(*eh)); // the writer reorders the edges
+	if(!e || !eh) {
+		perror("malloc");
+		return EXIT_FAILURE;
+	}
+
+	// half of the edges are near the diagonal, like the edges of a graph with a locality of the node ids
+	srand(1);
+	for(size_t i = 0; i < edges; i++) {
+		e[i].yval = rand() % nodes;
+		e[i].xval = i % 2 ? rand() % nodes : (e[i].yval + rand() % 64) % nodes;
+		eh[i] = e[i];
+	}
+
+	// the cells of the lookups, the first half are edges
+	size_t lookups = rows * 64;
+	uint64_t* cells = malloc(2 * lookups * sizeof(*cells));
+	if(!cells) {
+		perror("malloc");
+		return EXIT_FAILURE;
+	}
+	for(size_t i = 0; i < lookups; i++) {
+		size_t x = rand() % edges;
+		cells[2 * i] = i % 2 ? rand() % nodes : e[x].yval;
+		cells[2 * i + 1] = i % 2 ? rand() % nodes : e[x].xval;
+	}
+
+	BitsequenceParams bp = {0};
+	bp.factor = 4;
+	k2_write(nodes, nodes, e, edges, false, &w, &bp);
+	FileOff off_hybrid = bitwriter_len(&w) / 8; // the writer ends at a full byte
+	k2_write(nodes, nodes, eh, edges, true, &w, &bp);
+	free(e);
+	free(eh);
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	FileReader* fr = filereader_init(path, NULL);
+	if(!fr) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	Reader r;
+	reader_initf(fr, &r, 0);
+	K2Reader* k = k2_init(&r);
+	reader_initf(fr, &r, off_hybrid);
+	K2Reader* kh = k2_init(&r);
+	if(!k || !kh) {
+		fprintf(stderr, "failed to read the k2-tree\n");
+		return EXIT_FAILURE;
+	}
+
+	uint64_t s1 = 0, s2 = 0, elements = 0, v;
+	double start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			uint64_t p = j * nodes / rows; // rows spread evenly over the matrix
+			RingQueue queue;
+			queue_iter_init(k, p, &queue);
+			while(queue_iter_next(k, &queue, &v) == 1) {
+				s1 += v;
+				elements++;
+			}
+			queue_iter_finish(&queue);
+		}
+	}
+	double t1 = now() - start;
+
+	start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			K2Iterator it;
+			k2_iter_init_row(k, j * nodes / rows, &it);
+			while(k2_iter_next(&it, &v) == 1)
+				s2 += v;
+		}
+	}
+	double t2 = now() - start;
+
+	if(s1 != s2)
+		fprintf(stderr, "row iterators differ\n");
+
+	double n = (double) rows * rounds;
+	printf("k2 rows: %zu nodes, %zu rows, %.2f elements per row\n", nodes, rows, elements / n);
+	printf("queue %.2f us per row (%.2f M elements/s), stack %.2f us per row (%.2f M elements/s), speedup %.2fx\n",
+		t1 / n * 1e6, elements / t1 * 1e-6, t2 / n * 1e6, elements / t2 * 1e-6, t1 / t2);
+
+	// the columns are extracted in batches of adjacent columns, like the edges of a neighborhood
+	uint64_t buf[BATCH * 64];
+	size_t lens[BATCH];
+	uint64_t s3 = 0, s4 = 0;
+
+	start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			uint64_t q = j * nodes / rows;
+			for(uint64_t c = q; c < MIN(q + BATCH, nodes); c++) {
+				size_t len = k2_column(k, c, buf, 64);
+				for(size_t l = 0; l < len; l++)
+					s3 += buf[l];
+			}
+		}
+	}
+	double t3 = now() - start;
+
+	start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			uint64_t qs[BATCH];
+			uint64_t q = j * nodes / rows;
+			size_t n = MIN(BATCH, nodes - q);
+			for(size_t c = 0; c < n; c++)
+				qs[c] = q + c;
+
+			k2_columns(k, qs, n, buf, 64, lens);
+			for(size_t c = 0; c < n; c++)
+				for(size_t l = 0; l < lens[c]; l++)
+					s4 += buf[c * 64 + l];
+		}
+	}
+	double t4 = now() - start;
+
+	if(s3 != s4)
+		fprintf(stderr, "column extractions differ\n");
+
+	printf("k2 columns: batches of %d columns, single %.2f us per batch, batched %.2f us per batch, speedup %.2fx\n",
+		BATCH, t3 / n * 1e6, t4 / n * 1e6, t3 / t4);
+
+	uint64_t s5 = 0, s6 = 0;
+
+	start = now();
+	for(int i = 0; i < rounds; i++)
+		for(size_t j = 0; j < lookups; j++)
+			s5 += k2_get(k, cells[2 * j], cells[2 * j + 1]);
+	double t5 = now() - start;
+
+	start = now();
+	for(int i = 0; i < rounds; i++)
+		for(size_t j = 0; j < lookups; j++)
+			s6 += k2_get(kh, cells[2 * j], cells[2 * j + 1]);
+	double t6 = now() - start;
+
+	if(s5 != s6)
+		fprintf(stderr, "lookups differ\n");
+
+	n = (double) lookups * rounds;
+	printf("k2 get: %d levels, hybrid %d levels, %.2f ns per lookup, hybrid %.2f ns per lookup, speedup %.2fx\n",
+		k->levels, kh->levels, t5 / n * 1e9, t6 / n * 1e9, t5 / t6);
+
+	// the regions are near the diagonal, where most of the edges are
+	uint64_t s7 = 0, s8 = 0, cells_found = 0, p, q;
+
+	start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			uint64_t p1 = j * nodes / rows;
+			for(uint64_t r = p1; r < MIN(p1 + REGION, nodes); r++) {
+				K2Iterator it;
+				k2_iter_init_row(k, r, &it);
+				while(k2_iter_next(&it, &v) == 1) {
+					if(v >= p1 && v < p1 + REGION) {
+						s7 += r ^ v;
+						cells_found++;
+					}
+				}
+			}
+		}
+	}
+	double t7 = now() - start;
+
+	start = now();
+	for(int i = 0; i < rounds; i++) {
+		for(size_t j = 0; j < rows; j++) {
+			uint64_t p1 = j * nodes / rows;
+			K2RegionIterator it;
+			k2_region_init(k, p1, p1 + REGION, p1, p1 + REGION, &it);
+			while(k2_region_next(&it, &p, &q) == 1)
+				s8 += p ^ q;
+		}
+	}
+	double t8 = now() - start;
+
+	if(s7 != s8)
+		fprintf(stderr, "regions differ\n");
+
+	n = (double) rows * rounds;
+	printf("k2 region: %dx%d cells, %.2f cells per region, rows %.2f us per region, region %.2f us per region, speedup %.2fx\n",
+		REGION, REGION, cells_found / n, t7 / n * 1e6, t8 / n * 1e6, t7 / t8);
+
+	free(cells);
+	k2_destroy(k);
+	k2_destroy(kh);
+	filereader_close(fr);
+	unlink(path);
+
+	return s1 == s2 && s3 == s4 && s5 == s6 && s7 == s8 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -42,9 +42,18 @@ static void print_usage(bool error) {
 	"       --max-rank      [rank]           maximum rank of edges, set to 0 to remove limit (default: " STR(DEFAULT_MAX_RANK) ")\n"
 	"       --monograms                      enable the replacement of monograms\n"
 	"       --factor        [factor]         number of blocks of a bit sequence that are grouped into a superblock (default: " STR(DEFAULT_FACTOR) ")\n"
+	"       --select-sample [sample]         store every n-th one and zero of the bit sequences to speed up select; a value of 0 disables the hints (default: " STR(DEFAULT_SELECT_SAMPLE) ")\n"
+	"       --interleaved                    use bit sequences with the rank counters interleaved with the data in lines of 64 bytes\n"
+	"       --pef-labels                     store the edge labels with a partitioned Elias-Fano encoding\n"
+	"       --k2-hybrid                      store the incidence matrix as a k2-tree with a larger k at the upper levels\n"
+	"       --edge-nodes                     store the nodes of each edge additionally to decode the edges faster\n"
 	"       --sampling      [sampling]       sampling value of the dictionary; a value of 0 disables sampling (default: " STR(DEFAULT_SAMPLING) ")\n"
 	"       --no-rle                         disable run-length encoding\n"
 	"       --no-table                       do not add an extra table to speed up the decompression of the edges for an specific label\n"
+	"       --nt-summary                     add the ranks and positions of the nodes of the edges produced by each NT to the table\n"
+	"       --label-postings                 add the NT edges producing each label to the table to speed up the queries of a predicate\n"
+	"       --nt-counts                      store the number of edges of each label produced by each NT to count the edges faster\n"
+	"       --degrees                        store the degrees of the nodes to start the queries with several bound nodes at the rarest node\n"
 #ifdef RRR
 	"       --rrr                            use bitsequences based on R. Raman, V. Raman, and S. S. Rao [experimental]\n"
 	"                                        --factor can also be applied to this type of bit sequences\n"
@@ -96,9 +105,18 @@ enum opt {
 	OPT_C_MAX_RANK,
 	OPT_C_MONOGRAMS,
 	OPT_C_FACTOR,
+	OPT_C_SELECT_SAMPLE,
+	OPT_C_INTERLEAVED,
+	OPT_C_PEF_LABELS,
+	OPT_C_K2_HYBRID,
+	OPT_C_EDGE_NODES,
 	OPT_C_SAMPLING,
 	OPT_C_NO_RLE,
 	OPT_C_NO_TABLE,
+	OPT_C_NT_SUMMARY,
+	OPT_C_LABEL_POSTINGS,
+	OPT_C_NT_COUNTS,
+	OPT_C_DEGREES,
 #ifdef RRR
 	OPT_C_RRR,
 #endif
@@ -245,9 +263,18 @@ static int parse_args(int argc, char** argv, CGraphArgs* argd) {
 		{"max-rank", required_argument, 0, OPT_C_MAX_RANK},
 		{"monograms", no_argument, 0, OPT_C_MONOGRAMS},
 		{"factor", required_argument, 0, OPT_C_FACTOR},
+		{"select-sample", required_argument, 0, OPT_C_SELECT_SAMPLE},
+		{"interleaved", no_argument, 0, OPT_C_INTERLEAVED},
+		{"pef-labels", no_argument, 0, OPT_C_PEF_LABELS},
+		{"k2-hybrid", no_argument, 0, OPT_C_K2_HYBRID},
+		{"edge-nodes", no_argument, 0, OPT_C_EDGE_NODES},
 		{"sampling", required_argument, 0, OPT_C_SAMPLING},
 		{"no-rle", no_argument, 0, OPT_C_NO_RLE},
 		{"no-table", no_argument, 0, OPT_C_NO_TABLE},
+		{"nt-summary", no_argument, 0, OPT_C_NT_SUMMARY},
+		{"label-postings", no_argument, 0, OPT_C_LABEL_POSTINGS},
+		{"nt-counts", no_argument, 0, OPT_C_NT_COUNTS},
+		{"degrees", no_argument, 0, OPT_C_DEGREES},
 #ifdef RRR
 		{"rrr", no_argument, 0, OPT_C_RRR},
 #endif
@@ -279,9 +306,18 @@ static int parse_args(int argc, char** argv, CGraphArgs* argd) {
 	argd->params.max_rank = DEFAULT_MAX_RANK;
 	argd->params.monograms = DEFAULT_MONOGRAMS;
 	argd->params.factor = DEFAULT_FACTOR;
+	argd->params.select_sample = DEFAULT_SELECT_SAMPLE;
+	argd->params.interleaved = DEFAULT_INTERLEAVED;
+	argd->params.pef_labels = DEFAULT_PEF_LABELS;
+	argd->params.k2_hybrid = DEFAULT_K2_HYBRID;
+	argd->params.edge_nodes = DEFAULT_EDGE_NODES;
 	argd->params.sampling = DEFAULT_SAMPLING;
 	argd->params.rle = DEFAULT_RLE;
 	argd->params.nt_table = DEFAULT_NT_TABLE;
+	argd->params.nt_summary = DEFAULT_NT_SUMMARY;
+	argd->params.label_postings = DEFAULT_LABEL_POSTINGS;
+	argd->params.nt_counts = DEFAULT_NT_COUNTS;
+	argd->params.degrees = DEFAULT_DEGREES;
 #ifdef RRR
 	argd->params.rrr = DEFAULT_RRR;
 #endif
@@ -327,6 +363,31 @@ static int parse_args(int argc, char** argv, CGraphArgs* argd) {
 
 			argd->params.factor = v;
 			break;
+		case OPT_C_SELECT_SAMPLE:
+			check_mode(mode_compress, mode_read, true);
+			if(parse_optarg_int(&v) < 0) {
+				fprintf(stderr, "select-sample: expected integer\n");
+				return -1;
+			}
+
+			argd->params.select_sample = v;
+			break;
+		case OPT_C_INTERLEAVED:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.interleaved = true;
+			break;
+		case OPT_C_PEF_LABELS:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.pef_labels = true;
+			break;
+		case OPT_C_K2_HYBRID:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.k2_hybrid = true;
+			break;
+		case OPT_C_EDGE_NODES:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.edge_nodes = true;
+			break;
 		case OPT_C_SAMPLING:
 			check_mode(mode_compress, mode_read, true);
 			if(parse_optarg_int(&v) < 0) {
@@ -344,6 +405,22 @@ static int parse_args(int argc, char** argv, CGraphArgs* argd) {
 			check_mode(mode_compress, mode_read, true);
 			argd->params.nt_table = false;
 			break;
+		case OPT_C_NT_SUMMARY:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.nt_summary = true;
+			break;
+		case OPT_C_LABEL_POSTINGS:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.label_postings = true;
+			break;
+		case OPT_C_NT_COUNTS:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.nt_counts = true;
+			break;
+		case OPT_C_DEGREES:
+			check_mode(mode_compress, mode_read, true);
+			argd->params.degrees = true;
+			break;
 #ifdef RRR
 		case OPT_C_RRR:
 			check_mode(mode_compress, mode_read, true);
@@ -621,9 +698,18 @@ static int do_compress(const char* input, const char* output, const CGraphArgs*
 		printf("- max-rank: %d\n", argd->params.max_rank);
 		printf("- monograms: %s\n", argd->params.monograms ? "true" : "false");
 		printf("- factor: %d\n", argd->params.factor);
+		printf("- select-sample: %d\n", argd->params.select_sample);
+		printf("- interleaved: %s\n", argd->params.interleaved ? "true" : "false");
+		printf("- pef-labels: %s\n", argd->params.pef_labels ? "true" : "false");
+		printf("- k2-hybrid: %s\n", argd->params.k2_hybrid ? "true" : "false");
+		printf("- edge-nodes: %s\n", argd->params.edge_nodes ? "true" : "false");
 		printf("- sampling: %d\n", argd->params.sampling);
 		printf("- rle: %s\n", argd->params.rle ? "true" : "false");
 		printf("- nt-table: %s\n", argd->params.nt_table ? "true" : "false");
+		printf("- nt-summary: %s\n", argd->params.nt_summary ? "true" : "false");
+		printf("- label-postings: %s\n", argd->params.label_postings ? "true" : "false");
+		printf("- nt-counts: %s\n", argd->params.nt_counts ? "true" : "false");
+		printf("- degrees: %s\n", argd->params.degrees ? "true" : "false");
 #ifdef RRR
 		printf("- rrr: %s\n", argd->params.rrr ? "true" : "false");
 #endif
@@ -33,6 +33,9 @@ typedef struct CGraphW_ CGraphW;
 
 /**
  * Contains several parameters to influence the compression.
+ * New parameters are added to this struct, so its size depends on the version of libcgraph.
+ * Callers must fill it with the defaults of the library with `cgraphw_get_params`
+ * and change the parameters afterwards, instead of initializing a struct of their own.
  */
 typedef struct {
 	// Maximum rank
@@ -56,6 +59,33 @@ typedef struct {
 	// Using bitsequences of type RRR
 	bool rrr;
 #endif
+
+	// Store the superblock of every n-th one and zero of the bitsequences to speed up select, 0 disables the hints
+	int select_sample;
+
+	// Using bitsequences with the rank counters and the data interleaved in cache lines
+	bool interleaved;
+
+	// Store the edge labels of the start symbol in chunks, that are encoded as runs, bitmaps or with Elias-Fano
+	bool pef_labels;
+
+	// Store the incidence matrix of the start symbol as a k2-tree with a larger k at the upper levels and words as leaves
+	bool k2_hybrid;
+
+	// Store the nodes of each edge of the start symbol additionally, so the edges are decoded without the incidence matrix
+	bool edge_nodes;
+
+	// Add the summaries of the NTs to the NT table, so NTs are not decompressed if they cannot produce an edge with the bound nodes
+	bool nt_summary;
+
+	// Store the degrees of the nodes in the start symbol, so a query with several bound nodes starts with the rarest node
+	bool degrees;
+
+	// Add the postings of the NT edges producing each label to the NT table, so a query of a predicate only decompresses these edges
+	bool label_postings;
+
+	// Store the number of terminal edges of each label and rank produced by each NT, so the edges are counted without decompression
+	bool nt_counts;
 } CGraphCParams;
 
 /**
@@ -67,6 +97,50 @@ typedef struct CGraphR_ CGraphR;
 
 #define CGRAPH_LABELS_ALL ((CGraphEdgeLabel) -1)
 #define CGRAPH_NODES_ALL ((CGraphNode) -1)
+
+/**
+ * Contains several parameters to influence the reading of a compressed graph.
+ * Values of 0 select the default.
+ */
+typedef struct {
+	// Memory budget of the block cache in bytes, only used if libcgraph is built without mmap
+	size_t cache_size;
+
+	// Size of the cached blocks in bytes, must be a power of two (default is the page size)
+	size_t cache_block_size;
+
+	// Number of independently locked parts of the block cache
+	int cache_shards;
+
+	// Number of blocks read ahead after sequential cache misses, negative values disable the readahead
+	int cache_readahead;
+
+	// Decode the bit sequences into word aligned arrays in memory when opening the graph.
+	// This needs more memory, but queries do not parse the file layout anymore.
+	bool in_memory;
+
+	// Decode the rules and the index functions of the grammar into plain arrays when opening the graph.
+	// The grammar is then expanded without decoding the Elias-delta codes for every edge.
+	bool decode_tables;
+
+	// Memory budget in bytes of the cache of the expanded NTs, which is shared by all iterators (0 disables the cache)
+	size_t nt_cache_size;
+} CGraphRParams;
+
+/**
+ * Contains statistics of a reader handler.
+ */
+typedef struct {
+	// Number of block cache hits and misses (always 0 if mmap is used)
+	uint64_t cache_hits;
+	uint64_t cache_misses;
+
+	// Number of hits and misses of the cache of the expanded NTs (always 0 if the cache is disabled).
+	// NTs, whose expansion is too large to be cached, count as misses.
+	uint64_t nt_cache_hits;
+	uint64_t nt_cache_misses;
+} CGraphRStats;
+
 /**
  * Type used as parameters for the functions to read a compressed graph.
  */
@@ -116,17 +190,19 @@ void cgraphw_destroy(CGraphW* g);
 
 /**
  * Adds a new edge to the graph.
- * The two nodes and the edge label must be a 0-byte terminated string.
+ * The first `rank - 1` nodes and the edge label must be a 0-byte terminated string.
  * So strings with value NULL are not allowed.
+ * The last node of the edge is its index, which is not stored in the dictionary.
  * 
  * @param g Handler of the graph compressor.
- * @param n1 Source node of the edge.
- * @param n2 Destination node of the edge.
+ * @param rank Rank of the edge including the index.
  * @param label Label of the edge.
+ * @param nodes The `rank - 1` nodes of the edge.
+ * @param edge_index Index of the edge, used as its last node.
  * @return 0, if no errors occurred, otherwise -1.
  */
 CGRAPH_API
-int cgraphw_add_edge(CGraphW* g, const CGraphRank rank, const char* label, const char** nodes);
+int cgraphw_add_edge(CGraphW* g, const CGraphRank rank, const char* label, const char** nodes, size_t edge_index);
 
 /**
  * Adds a new node to the graph.
@@ -142,9 +218,19 @@ int cgraphw_add_edge(CGraphW* g, const CGraphRank rank, const char* label, const
 CGRAPH_API
 int cgraphw_add_node(CGraphW* g, const char* n);
 
+/**
+ * Returns the compression parameters, which are the defaults of the library for a new handler.
+ * 
+ * @param g Handler of the graph compressor.
+ * @param p Parameters for the compression, which are overwritten.
+ */
+CGRAPH_API
+void cgraphw_get_params(CGraphW* g, CGraphCParams* p);
+
 /**
  * Sets the compression parameters.
  * Must be done before compressing or writing the graph.
+ * The parameters should be obtained with `cgraphw_get_params` before they are changed.
  * 
  * @param g Handler of the graph compressor.
  * @param p Parameters for the compression.
@@ -157,10 +243,11 @@ void cgraphw_set_params(CGraphW* g, const CGraphCParams* p);
  * After this function is called, no more edges can be added to the graph.
  * 
  * @param g Handler of the graph compressor.
+ * @param edge_index Number of the edge indices, so the node ids cover the indices of all edges.
  * @return 0, if no errors occurred, otherwise -1.
  */
 CGRAPH_API
-int cgraphw_compress(CGraphW* g);
+int cgraphw_compress(CGraphW* g, size_t edge_index);
 
 /**
  * Writes the compressed graph to a file.
@@ -179,13 +266,61 @@ int cgraphw_write(CGraphW* g, const char* path, bool verbose);
  * Creates a handler for a file of a compressed graph.
  * If the file was not read correctly, e.g.
  * because the file contains wrong data, `NULL` is returned.
- * 
+ *
+ * The handler does not contain a shared read position, so all query functions
+ * (edges, nodes, locate and extract) may be called from multiple threads on the same handler.
+ * A single iterator must only be used by one thread at a time.
+ *
  * @param path Path of the graph file; can be absolute or relative.
  * @return Handler used for the calls to libcgraph.
  */
 CGRAPH_API
 CGraphR* cgraphr_init(const char* path);
 
+/**
+ * Creates a handler for a file of a compressed graph with the given parameters.
+ * If `p` is `NULL`, the default parameters are used.
+ *
+ * @param path Path of the graph file; can be absolute or relative.
+ * @param p Parameters of the reader.
+ * @return Handler used for the calls to libcgraph.
+ */
+CGRAPH_API
+CGraphR* cgraphr_init_params(const char* path, const CGraphRParams* p);
+
+/**
+ * Creates a handler for a compressed graph that is already in the memory, e.g. embedded into the binary.
+ * The data are read without copying them, so the buffer must not be changed or freed before the handler is destroyed.
+ * Bit sequences with interleaved lines are only used directly, if the buffer is aligned to 64 bytes.
+ *
+ * @param data Content of a graph file.
+ * @param len Length of the data in bytes.
+ * @return Handler used for the calls to libcgraph.
+ */
+CGRAPH_API
+CGraphR* cgraphr_init_buffer(const void* data, size_t len);
+
+/**
+ * Creates a handler for a compressed graph in the memory with the given parameters.
+ * If `p` is `NULL`, the default parameters are used. The cache parameters are ignored.
+ *
+ * @param data Content of a graph file.
+ * @param len Length of the data in bytes.
+ * @param p Parameters of the reader.
+ * @return Handler used for the calls to libcgraph.
+ */
+CGRAPH_API
+CGraphR* cgraphr_init_buffer_params(const void* data, size_t len, const CGraphRParams* p);
+
+/**
+ * Writes the statistics of this handler, e.g. to size the block cache.
+ *
+ * @param g Handler of the graph reader.
+ * @param s Statistics of the handler.
+ */
+CGRAPH_API
+void cgraphr_stats(CGraphR* g, CGraphRStats* s);
+
 /**
  * Frees the resources of this handler and does the unmapping of the files from the memory.
  * 
@@ -359,6 +494,22 @@ bool cgraphr_edges_next(CGraphEdgeIterator* it, CGraphEdge* e);
 CGRAPH_API
 void cgraphr_edges_finish(CGraphEdgeIterator* it);
 
+/**
+ * Counts the edges, that would be returned by `cgraphr_edges` with the same parameters,
+ * without allocating the nodes of each edge.
+ * The nodes may be `NULL` to count all edges with the given rank and label, like with no bound node.
+ * If no node is bound and the graph is compressed with the counts of the NTs,
+ * the edges are counted without decompressing the NTs.
+ *
+ * @param g Handler of the graph reader.
+ * @param rank Rank of the edges or `CGRAPH_NODES_ALL`.
+ * @param label Edge label or `CGRAPH_LABELS_ALL`.
+ * @param nodes Bound nodes or `CGRAPH_NODES_ALL` at the positions of the edges, may be `NULL`.
+ * @return Number of the edges or -1 if an error occured.
+ */
+CGRAPH_API
+int64_t cgraphr_edges_count(CGraphR* g, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes);
+
 /**
  * Checks if the given edge exists in the graph.
  * 
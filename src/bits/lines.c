@@ -0,0 +1,68 @@
+/**
+ * @file lines.c
+ * @author FR
+ */
+
+#include "lines.h"
+
+#include <stdlib.h>
+#include <arith.h>
+
+uint64_t* lines_build(const uint64_t* words, uint64_t len) {
+	uint64_t nwords = DIVUP(len, 64);
+	uint64_t nlines = lines_count(len);
+
+	uint64_t* lines;
+	if(posix_memalign((void**) &lines, LINE_WORDS * sizeof(uint64_t), nlines * LINE_WORDS * sizeof(uint64_t)) != 0)
+		return NULL;
+
+	uint64_t ones = 0;
+	for(uint64_t l = 0; l < nlines; l++) {
+		uint64_t* line = lines + LINE_WORDS * l;
+		uint64_t h = ones;
+
+		int rel = 0;
+		for(int j = 0; j < LINE_WORDS - 1; j++) {
+			if(j > 0 && j % 2 == 0)
+				h |= ((uint64_t) rel) << (LINE_ABS_BITS + 9 * (j / 2 - 1));
+
+			uint64_t w = (LINE_WORDS - 1) * l + j;
+			line[j + 1] = w < nwords ? words[w] : 0;
+			rel += POPCNT64(line[j + 1]);
+		}
+
+		line[0] = h;
+		ones += rel;
+	}
+
+	return lines;
+}
+
+uint64_t* lines_samples(const uint64_t* lines, uint64_t len, uint64_t count, bool ones) {
+	uint64_t nlines = lines_count(len);
+	uint64_t nsamples = lines_samples_count(count) - 1;
+
+	uint64_t* samples = malloc((nsamples + 1) * sizeof(*samples));
+	if(!samples)
+		return NULL;
+
+	uint64_t line = 0;
+	for(uint64_t s = 0; s < nsamples; s++) {
+		uint64_t target = s * SELECT_SAMPLE + 1;
+
+		// find the last line with less than target ones (zeros) before it
+		while(line + 1 < nlines) {
+			uint64_t before = line_abs(lines[LINE_WORDS * (line + 1)]);
+			if(!ones)
+				before = (line + 1) * LINE_BITS - before;
+			if(before >= target)
+				break;
+			line++;
+		}
+
+		samples[s] = line;
+	}
+	samples[nsamples] = nlines - 1;
+
+	return samples;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file lines.h
+ * @author FR
+ */
+
+#ifndef LINES_H
+#define LINES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <arith.h>
+
+// Layout of bit sequences with a rank directory interleaved in lines of 64 bytes:
+// The header word contains the ones before the line (37 bits) and the ones in the first 2, 4 and 6 data words (9 bits each).
+// It is followed by 7 data words, the bits are stored from the lowest to the highest bit of each word.
+// An additional line at the end only stores the number of ones in its header.
+#define LINE_WORDS 8
+#define LINE_BITS (64 * (LINE_WORDS - 1))
+#define LINE_ABS_BITS 37
+#define LINE_MAX_ONES (1ULL << LINE_ABS_BITS)
+
+// Every SELECT_SAMPLE-th one and zero is sampled with its line
+#define SELECT_SAMPLE 2048
+
+#define line_abs(h) ((h) & ((1ULL << LINE_ABS_BITS) - 1))
+#define line_rel(h, j) ((j) ? ((h) >> (LINE_ABS_BITS + 9 * ((j) - 1))) & 0x1ff : 0)
+
+// number of lines including the additional line
+#define lines_count(len) (DIVUP(len, LINE_BITS) + 1)
+// number of select samples including the additional last line
+#define lines_samples_count(n) (DIVUP(n, SELECT_SAMPLE) + 1)
+
+// Creates the lines of `len` bits, given as words with the first bit at the lowest bit.
+// The lines are aligned to 64 bytes.
+uint64_t* lines_build(const uint64_t* words, uint64_t len);
+
+// Returns the line of every SELECT_SAMPLE-th one (or zero), followed by the last line.
+// `count` is the number of ones (or zeros).
+uint64_t* lines_samples(const uint64_t* lines, uint64_t len, uint64_t count, bool ones);
+
+#endif
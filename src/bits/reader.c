@@ -12,23 +12,33 @@
 #include <inttypes.h>
 #include <assert.h>
 
+#include <string.h>
+
 #ifdef USE_MMAP
 #include <sys/mman.h>
 #else
-#include <string.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
 
 // to ensure, that the cache capacity does not exceeds the maximum of int
 #include <limits.h>
+#include <constants.h>
 #endif
 
 #include <panic.h>
 #include <arith.h>
 #include <memdup.h>
 
+#define likely(x) (__builtin_expect(!!(x), 1))
 #define unlikely(x) (__builtin_expect((x), 0))
 
+#ifndef USE_MMAP
+static int cache_init(FileReader* r, const CacheParams* p);
+static void cache_destroy(FileReader* r);
+#endif
+
 // The filereader will be stored on the heap
-FileReader* filereader_init(const char* path) {
+FileReader* filereader_init(const char* path, const CacheParams* p) {
 	int fd = open(path, O_RDONLY);
 	if(fd < 0)
 		return NULL;
@@ -40,6 +50,8 @@ FileReader* filereader_init(const char* path) {
 	FileOff size = st.st_size;
 
 #ifdef USE_MMAP
+	(void) p; // no block cache is used with mmap
+
 	// mmapping the file to the memory - available at pointer f
 	uint8_t* mm = (uint8_t*) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
 	if(mm == MAP_FAILED)
@@ -54,18 +66,20 @@ FileReader* filereader_init(const char* path) {
 #ifdef USE_MMAP
 	r->mm = mm;
 #else
-	r->cache_size = 0;
-	for(int i = 0; i < CACHE_CAPACITY; i++)
-		r->cache[i].block = -1;
-	r->cache_list_head = -1;
-	r->cache_list_tail = -1;
+	r->mm = NULL;
+	if(cache_init(r, p) < 0)
+		goto err_2;
 #endif
 
 	r->bitlen = 8 * size;
-	r->bitpos = 0;
+	r->in_memory = false;
 
 	return r;
 
+#ifndef USE_MMAP
+err_2:
+	free(r);
+#endif
 err_1:
 #ifdef USE_MMAP
 	munmap(mm, size);
@@ -75,12 +89,39 @@ err_0:
 	return NULL;
 }
 
+FileReader* filereader_init_buffer(const void* data, size_t size) {
+	if(!data)
+		return NULL;
+
+	FileReader* r = malloc(sizeof(*r));
+	if(!r)
+		return NULL;
+
+	r->fd = -1;
+	r->mm = data;
+#ifndef USE_MMAP
+	r->shard_count = 0; // no cache needed
+	r->shards = NULL;
+#endif
+
+	r->bitlen = 8 * (FileOff) size;
+	r->in_memory = false;
+
+	return r;
+}
+
 void filereader_close(FileReader* r) {
+	if(r->fd >= 0) {
 #ifdef USE_MMAP
-	munmap(r->mm, r->bitlen / 8); // unmapping the file
+		munmap((void*) r->mm, r->bitlen / 8); // unmapping the file
 #endif
 
-	close(r->fd); // closing the file descriptor
+		close(r->fd); // closing the file descriptor
+	}
+
+#ifndef USE_MMAP
+	cache_destroy(r);
+#endif
 	free(r);
 }
 
@@ -100,167 +141,343 @@ void reader_init(const Reader* src, Reader* dst, FileOff byte_off) {
 	reader_bitpos(dst, 0);
 }
 
+int sections_read(FileReader* fr, FileOff byte_off, Sections* s) {
+	memset(s, 0, sizeof(*s));
+
+	FileOff len = fr->bitlen / 8;
+	if(byte_off + 8 > len)
+		return -1;
+
+	Reader r;
+	reader_initf(fr, &r, byte_off);
+
+	uint64_t n = reader_readint(&r, 64);
+	if(n > (len - byte_off - 8) / 24)
+		return -1;
+
+	for(uint64_t i = 0; i < n; i++) {
+		uint64_t id = reader_readint(&r, 64);
+		uint64_t off = reader_readint(&r, 64);
+		uint64_t l = reader_readint(&r, 64);
+
+		if(off == 0 || off > len || l > len - off)
+			return -1;
+		if(id >= SECTION_COUNT) // unknown section of a newer writer
+			continue;
+
+		s->off[id] = off;
+		s->len[id] = l;
+	}
+
+	return 0;
+}
+
+bool reader_section(FileReader* fr, const Sections* s, int id, Reader* r) {
+	if(s->off[id] == 0)
+		return false;
+
+	reader_initf(fr, r, s->off[id]);
+	return true;
+}
+
 void reader_bitpos(Reader* r, FileOff pos) {
 	pos += r->bitoff;
 	if(unlikely(pos < 0 || pos >= r->r->bitlen))
 		panic("illegal bit offset %" PRIu64 " with bit length %" PRIu64, pos, r->r->bitlen);
 
-	r->r->bitpos = pos;
+	r->bitpos = pos;
 }
 
 static inline void check_remaining(Reader* r, FileOff n) {
-	if(unlikely(r->r->bitpos + n > r->r->bitlen))
-		panic("trying to read %" PRIu64 " bits but only %" PRIu64 " are available", n, r->r->bitlen - r->r->bitpos);
+	if(unlikely(r->bitpos + n > r->r->bitlen))
+		panic("trying to read %" PRIu64 " bits but only %" PRIu64 " are available", n, r->r->bitlen - r->bitpos);
 }
 
 #ifndef USE_MMAP
-// check assertions of the cache size
-static_assert(CACHE_CAPACITY > 0 && (CACHE_CAPACITY & (CACHE_CAPACITY - 1)) == 0, "CACHE_CAPACITY must be a power of two");
-static_assert(CACHE_CAPACITY <= INT_MAX, "CACHE_CAPACITY must not exceed the maximum of int");
-
-static inline int place(FileOff block) {
-	return (block * 0x9E3779B97F4A7C15L) >> __builtin_clzll(CACHE_CAPACITY - 1);
-}
-
-static CacheElement* cache_locate(FileReader* r, FileOff block, int* first_pos, int* pos) {
-	int first = place(block);
-	for(int i = first;; i = (i + 1) & (CACHE_CAPACITY - 1)) {
-		CacheElement* e = &r->cache[i];
-		if(e->block == -1) { // entry is unused if value is -1
-			*first_pos = first;
-			*pos = i;
-			return NULL;
-		}
-		if(e->block == block) {
-			*first_pos = first;
-			*pos = i;
-			return e;
+static inline uint64_t hash_block(FileOff block) {
+	return block * 0x9E3779B97F4A7C15L;
+}
+
+static int cache_init(FileReader* r, const CacheParams* p) {
+	size_t block_size = p && p->block_size > 0 ? p->block_size : (size_t) sysconf(_SC_PAGESIZE);
+	if(block_size == 0 || (block_size & (block_size - 1)) != 0)
+		return -1;
+
+	size_t size = p && p->size > 0 ? p->size : DEFAULT_CACHE_SIZE;
+	int shards = p && p->shards > 0 ? p->shards : DEFAULT_CACHE_SHARDS;
+	int readahead = p && p->readahead != 0 ? p->readahead : DEFAULT_CACHE_READAHEAD; // negative values disable the readahead
+	if(readahead < 0)
+		readahead = 0;
+	if(readahead > CACHE_MAX_READAHEAD)
+		readahead = CACHE_MAX_READAHEAD;
+
+	size_t capacity = size / block_size / shards;
+	if(capacity < 1)
+		capacity = 1;
+	if(capacity > INT_MAX / 2)
+		return -1;
+	if(readahead >= capacity)
+		readahead = capacity - 1;
+
+	r->block_size = block_size;
+	r->block_shift = __builtin_ctzll(block_size);
+	r->extent_shift = BIT_LEN(readahead); // extents of 2^extent_shift blocks contain the block and its readahead
+	r->readahead = readahead;
+	r->last_miss = -2; // no block follows it, so the first miss never counts as sequential
+
+	int buckets = 1;
+	while(buckets < capacity)
+		buckets <<= 1;
+
+	r->shards = malloc(shards * sizeof(*r->shards));
+	if(!r->shards)
+		return -1;
+
+	int i;
+	for(i = 0; i < shards; i++) {
+		CacheShard* s = &r->shards[i];
+
+		s->capacity = capacity;
+		s->size = 0;
+		s->bucket_mask = buckets - 1;
+		s->list_head = -1;
+		s->list_tail = -1;
+		s->hits = 0;
+		s->misses = 0;
+
+		s->elements = malloc(capacity * sizeof(*s->elements));
+		s->buckets = malloc(buckets * sizeof(*s->buckets));
+		s->data = malloc(capacity * block_size);
+		if(!s->elements || !s->buckets || !s->data || pthread_mutex_init(&s->lock, NULL) != 0) {
+			free(s->elements);
+			free(s->buckets);
+			free(s->data);
+			goto err_0;
 		}
+
+		for(int j = 0; j < buckets; j++)
+			s->buckets[j] = -1;
 	}
+
+	r->shard_count = shards;
+	return 0;
+
+err_0:
+	r->shard_count = i; // only destroy the initialized shards
+	cache_destroy(r);
+	return -1;
 }
 
-static int cache_remove_lowest(FileReader* r) {
-	int tail;
-	if((tail = r->cache_list_tail) == -1)
-		return -1;
+static void cache_destroy(FileReader* r) {
+	for(int i = 0; i < r->shard_count; i++) {
+		CacheShard* s = &r->shards[i];
+
+		pthread_mutex_destroy(&s->lock);
+		free(s->elements);
+		free(s->buckets);
+		free(s->data);
+	}
+	free(r->shards);
+}
+
+void filereader_stats(FileReader* r, uint64_t* hits, uint64_t* misses) {
+	uint64_t h = 0, m = 0;
+	for(int i = 0; i < r->shard_count; i++) {
+		CacheShard* s = &r->shards[i];
+
+		pthread_mutex_lock(&s->lock);
+		h += s->hits;
+		m += s->misses;
+		pthread_mutex_unlock(&s->lock);
+	}
+
+	if(hits)
+		*hits = h;
+	if(misses)
+		*misses = m;
+}
+
+static inline CacheShard* shard_place(FileReader* r, FileOff block) {
+	return &r->shards[(hash_block(block >> r->extent_shift) >> 32) % r->shard_count];
+}
+
+static inline int* shard_bucket(CacheShard* s, FileOff block) {
+	return &s->buckets[(hash_block(block) >> 32) & s->bucket_mask];
+}
+
+static int shard_find(CacheShard* s, FileOff block) {
+	for(int i = *shard_bucket(s, block); i != -1; i = s->elements[i].hash_next)
+		if(s->elements[i].block == block)
+			return i;
+	return -1;
+}
 
-	CacheElement* lowest = &r->cache[tail];
-	lowest->block = -1;
+static void list_remove(CacheShard* s, int i) {
+	CacheElement* e = &s->elements[i];
 
-	int prev = lowest->list_prev;
-	r->cache_list_tail = prev;
+	if(e->list_prev == -1)
+		s->list_head = e->list_next;
+	else
+		s->elements[e->list_prev].list_next = e->list_next;
 
-	if(prev == -1)
-		r->cache_list_head = -1;
+	if(e->list_next == -1)
+		s->list_tail = e->list_prev;
 	else
-		r->cache[prev].list_next = -1;
-
-	r->cache_size--;
-	return tail;
-}
-
-static const uint8_t* read_block(FileReader* r, FileOff block) {
-	int f, i, lo;
-	CacheElement* e = cache_locate(r, block, &f, &i);
-	if(!e) {
-		// to keep the runtimes low, the size of the cache must not exceed 75% of the capacity
-		if(r->cache_size >= (int)(0.75f * CACHE_CAPACITY)) {
-			if((lo = cache_remove_lowest(r)) >= 0) {
-				// checking, if the lowest cache value was skipped in `cache_locate`
-				if(f <= i) {
-					if(f <= lo && lo <= i)
-						i = lo;
-				}
-				else {
-					if(f <= lo || lo <= i)
-						i = lo;
-				}
-			}
-		}
+		s->elements[e->list_next].list_prev = e->list_prev;
+}
+
+static void list_push_front(CacheShard* s, int i) {
+	CacheElement* e = &s->elements[i];
+	int h = s->list_head;
+
+	e->list_prev = -1;
+	e->list_next = h;
+
+	s->list_head = i;
+	if(h == -1)
+		s->list_tail = i;
+	else
+		s->elements[h].list_prev = i;
+}
+
+// Returns an unused element, if the shard is full, the least recently used block is evicted.
+static int shard_alloc(CacheShard* s) {
+	if(s->size < s->capacity)
+		return s->size++;
 
-		r->cache_size++;
+	int i = s->list_tail;
+	list_remove(s, i);
 
-		e = &r->cache[i];
-		e->block = block;
-		if(pread(r->fd, e->data, CACHE_BLOCK_SIZE, CACHE_BLOCK_SIZE * block) < 0)
-			panic("failed to read a block at position %" PRIu64, CACHE_BLOCK_SIZE * block);
+	// remove the element from its hash chain
+	int* p = shard_bucket(s, s->elements[i].block);
+	while(*p != i)
+		p = &s->elements[*p].hash_next;
+	*p = s->elements[i].hash_next;
 
-		// move new element to front
-		int h = r->cache_list_head;
+	return i;
+}
 
-		e->list_prev = -1;
-		e->list_next = h;
+// Loads the block and, if it was accessed sequentially, the following blocks of its extent with a single read.
+// The lock of the shard must be held.
+static int shard_load(FileReader* r, CacheShard* s, FileOff block) {
+	int n = 1;
 
-		r->cache_list_head = i;
-		if(h == -1)
-			r->cache_list_tail = i;
-		else
-			r->cache[h].list_prev = i;
+	FileOff prev = atomic_load_explicit(&r->last_miss, memory_order_relaxed);
+	if(r->readahead > 0 && prev + 1 == block) {
+		FileOff extent_end = ((block >> r->extent_shift) + 1) << r->extent_shift;
+		FileOff file_end = DIVUP(r->bitlen / 8, r->block_size);
+
+		while(n <= r->readahead && block + n < extent_end && block + n < file_end && shard_find(s, block + n) == -1)
+			n++;
 	}
-	else {
-		// move existing element to front
 
-		if(r->cache_list_head != i) {
-			// current is not at the front
+	// a sequential scan misses next at the block after the last one read ahead
+	atomic_store_explicit(&r->last_miss, block + n - 1, memory_order_relaxed);
 
-			int prev = e->list_prev;
-			int next = e->list_next;
+	struct iovec iov[CACHE_MAX_READAHEAD + 1];
+	int elements[CACHE_MAX_READAHEAD + 1];
 
-			if(r->cache_list_tail == i) {
-				// current element is at the end
-				r->cache[prev].list_next = -1;
-				r->cache_list_tail = prev;
-			}
-			else {
-				// n is at the middle
-				r->cache[prev].list_next = next;
-				r->cache[next].list_prev = prev;
-			}
+	for(int k = 0; k < n; k++) {
+		int i = shard_alloc(s);
+
+		CacheElement* e = &s->elements[i];
+		e->block = block + k;
 
-			r->cache[r->cache_list_head].list_prev = i;
-			e->list_prev = -1;
-			e->list_next = r->cache_list_head;
-			r->cache_list_head = i;
+		int* bucket = shard_bucket(s, e->block);
+		e->hash_next = *bucket;
+		*bucket = i;
+
+		list_push_front(s, i);
+
+		elements[k] = i;
+		iov[k].iov_base = s->data + ((size_t) i << r->block_shift);
+		iov[k].iov_len = r->block_size;
+	}
+
+	if(preadv(r->fd, iov, n, block << r->block_shift) < 0)
+		panic("failed to read a block at position %" PRIu64, block << r->block_shift);
+
+	// the requested block should be the most recently used one
+	list_remove(s, elements[0]);
+	list_push_front(s, elements[0]);
+
+	return elements[0];
+}
+
+// Copies n bytes at the offset off of a block.
+static void cache_copy(FileReader* r, FileOff block, size_t off, uint8_t* data, size_t n) {
+	CacheShard* s = shard_place(r, block);
+	pthread_mutex_lock(&s->lock);
+
+	int i = shard_find(s, block);
+	if(i >= 0) {
+		s->hits++;
+
+		// move existing element to front
+		if(s->list_head != i) {
+			list_remove(s, i);
+			list_push_front(s, i);
 		}
 	}
+	else {
+		s->misses++;
+		i = shard_load(r, s, block);
+	}
 
-	return e->data;
+	memcpy(data, s->data + ((size_t) i << r->block_shift) + off, n);
+	pthread_mutex_unlock(&s->lock);
 }
 
 static inline void read_bytes(Reader* r, void* data, FileOff byteindex, size_t nbytes) {
 	FileReader* fr = r->r;
 
-	// determine the offset of the current block
-	FileOff block = byteindex / CACHE_BLOCK_SIZE;
-	size_t block_index = byteindex % CACHE_BLOCK_SIZE;
+	if(fr->mm) { // reading from a buffer
+		memcpy(data, fr->mm + byteindex, nbytes);
+		return;
+	}
 
-	const uint8_t* block_buf = read_block(fr, block);
+	// determine the offset of the current block
+	FileOff block = byteindex >> fr->block_shift;
+	size_t block_index = byteindex & (fr->block_size - 1);
 
-	size_t read_size = MIN(CACHE_BLOCK_SIZE - block_index, nbytes);
-	memcpy(data, block_buf + block_index, read_size);
+	size_t read_size = MIN(fr->block_size - block_index, nbytes);
+	cache_copy(fr, block, block_index, data, read_size);
 
 	while(read_size < nbytes) {
-		block_buf = read_block(fr, ++block);
+		size_t copy_size = MIN(fr->block_size, nbytes - read_size);
 
-		size_t copy_size = MIN(CACHE_BLOCK_SIZE, nbytes - read_size);
-
-		memcpy(data + read_size, block_buf, copy_size);
+		cache_copy(fr, ++block, 0, data + read_size, copy_size);
 		read_size += copy_size;
 	}
 }
+#else
+void filereader_stats(FileReader* r, uint64_t* hits, uint64_t* misses) {
+	(void) r; // no block cache is used with mmap
+
+	if(hits)
+		*hits = 0;
+	if(misses)
+		*misses = 0;
+}
 #endif
 
 static inline const uint8_t* get_bytes(Reader* r, size_t byte_pos, size_t n) {
-	uint8_t* data;
+	const uint8_t* data;
 	#ifdef USE_MMAP
 		data = r->r->mm + byte_pos;
 	#else
+		if(r->r->mm)
+			return r->r->mm + byte_pos;
+
 		if(n > BUFFER_SIZE)
 			panic("number of bytes (%zu) exceeds the maximum buffer size (%d)", n, BUFFER_SIZE);
 
-		data = r->r->read_buf;
+		// every thread has its own buffer, so concurrent reads do not overwrite each other
+		static _Thread_local uint8_t read_buf[BUFFER_SIZE];
+
 		if(n > 0)
-			read_bytes(r, data, byteindex, n);
+			read_bytes(r, read_buf, byte_pos, n);
+		data = read_buf;
 	#endif
 
 	return data;
@@ -269,7 +486,7 @@ static inline const uint8_t* get_bytes(Reader* r, size_t byte_pos, size_t n) {
 const uint8_t* reader_read(Reader* r, size_t n) {
 	check_remaining(r, 8 * n);
 
-	FileOff bitpos = r->r->bitpos;
+	FileOff bitpos = r->bitpos;
 	FileOff byteindex = bitpos / 8;
 	FileOff bitoff = bitpos % 8;
 
@@ -278,15 +495,15 @@ const uint8_t* reader_read(Reader* r, size_t n) {
 
 	const uint8_t* data = get_bytes(r, byteindex, n);
 
-	r->r->bitpos += 8 * n;
+	r->bitpos += 8 * n;
 	return data;
 }
 
 bool reader_readbit(Reader* r) {
 	check_remaining(r, 1);
 
-	FileOff byteindex = r->r->bitpos / 8;
-	FileOff bitoff = r->r->bitpos % 8;
+	FileOff byteindex = r->bitpos / 8;
+	FileOff bitoff = r->bitpos % 8;
 
 	bool b;
 #ifdef USE_MMAP
@@ -298,7 +515,7 @@ bool reader_readbit(Reader* r) {
 	b = ((byte >> (8 - bitoff - 1)) & 1) == 1;
 #endif
 
-	r->r->bitpos++;
+	r->bitpos++;
 	return b;
 }
 
@@ -352,7 +569,7 @@ uint64_t reader_readint(Reader* r, int bits) {
 
 	check_remaining(r, bits);
 
-	FileOff pos = r->r->bitpos;
+	FileOff pos = r->bitpos;
 	FileOff byte_pos = pos / 8;
 	int bitoff = pos % 8;
 	int byte_len = BYTE_LEN(pos + bits) - byte_pos;
@@ -377,7 +594,7 @@ uint64_t reader_readint(Reader* r, int bits) {
 			}
 		}
 
-		r->r->bitpos = pos + bits;
+		r->bitpos = pos + bits;
 		return res;
 	}
 
@@ -394,9 +611,8 @@ uint64_t reader_readint(Reader* r, int bits) {
 #ifndef __SIZEOF_INT128__
 		panic("number of bytes (%d) exceeds the maximum number of bytes (%lu)", byte_len, sizeof(uint64_t));
 #else
-		uint64_t mask = (((uint64_t) 1) << bits) - 1;
 		val = to_int128(data, byte_len) >> shift;
-		res = val & mask;
+		res = bits < 64 ? val & ((((uint64_t) 1) << bits) - 1) : val; // shifting by 64 is undefined
 #endif
 	}
 	else {
@@ -404,18 +620,18 @@ uint64_t reader_readint(Reader* r, int bits) {
 		res = uint_extract(val, shift, bits);
 	}
 
-	r->r->bitpos = pos + bits;
+	r->bitpos = pos + bits;
 	return res;
 }
 
 uint8_t reader_readbyte(Reader* r) {
 	check_remaining(r, 8);
 
-	FileOff bitpos = r->r->bitpos;
+	FileOff bitpos = r->bitpos;
 	FileOff byteindex = bitpos / 8;
 	FileOff bitoff = bitpos % 8;
 
-	r->r->bitpos += 8;
+	r->bitpos += 8;
 
 	if(bitoff == 0) {
 #ifdef USE_MMAP
@@ -429,7 +645,7 @@ uint8_t reader_readbyte(Reader* r) {
 	}
 
 #ifdef USE_MMAP
-	uint8_t* data = r->r->mm + byteindex;
+	const uint8_t* data = r->r->mm + byteindex;
 #else
 	uint8_t data[2];
 	read_bytes(r, data, byteindex, sizeof(data));
@@ -438,22 +654,72 @@ uint8_t reader_readbyte(Reader* r) {
 	return (data[0] << bitoff) | (data[1] >> (8 - bitoff));
 }
 
+// Returns the next 64 bits at the current position without moving it.
+// Bits after the end of the file are 0, so the caller must check the number of used bits.
+static inline uint64_t peek64(Reader* r) {
+	FileOff byte_pos = r->bitpos / 8;
+	int bitoff = r->bitpos % 8;
+	FileOff avail = r->r->bitlen / 8 - byte_pos;
+
+	const uint8_t* data;
+	uint8_t buf[9];
+	if(likely(avail >= 9))
+		data = get_bytes(r, byte_pos, 9);
+	else {
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf, get_bytes(r, byte_pos, avail), avail);
+		data = buf;
+	}
+
+	uint64_t v = to_int(data, 8);
+	if(bitoff)
+		v = (v << bitoff) | (data[8] >> (8 - bitoff));
+
+	return v;
+}
+
 // nbytes is returned as a pointer, so calls to this function look much better
 uint64_t reader_vbyte(Reader* r, size_t* nbytes) {
 	uint64_t val = 0;
 	size_t n = 0;
-	int shift = 0;
 
-	uint8_t nibble;
-	for(;;) {
-		nibble = reader_readbyte(r);
-		n++;
+	// The terminating byte of a vbyte is the first byte with the highest bit set.
+	// If it is within the next 8 bytes, the value is decoded at once.
+	uint64_t w = __builtin_bswap64(peek64(r)); // first byte at the lowest bits
+	uint64_t ends = w & 0x8080808080808080ULL;
+	if(likely(ends)) {
+		n = __builtin_ctzll(ends) / 8 + 1;
+		check_remaining(r, 8 * n);
+
+		if(n < 8)
+			w &= (1ULL << (8 * n)) - 1;
+
+#ifdef __BMI2__
+		val = _pext_u64(w, 0x7f7f7f7f7f7f7f7fULL);
+#else
+		// packing the 7 bit groups by doubling the group size in each step
+		w &= 0x7f7f7f7f7f7f7f7fULL;
+		w = (w & 0x007f007f007f007fULL) | ((w & 0x7f007f007f007f00ULL) >> 1);
+		w = (w & 0x00003fff00003fffULL) | ((w & 0x3fff00003fff0000ULL) >> 2);
+		val = (w & 0x000000000fffffffULL) | ((w & 0x0fffffff00000000ULL) >> 4);
+#endif
+
+		r->bitpos += 8 * n;
+	}
+	else {
+		int shift = 0;
+
+		uint8_t nibble;
+		for(;;) {
+			nibble = reader_readbyte(r);
+			n++;
 
-		val |= ((uint64_t) (nibble & 0x7f)) << shift;
-		shift += 7;
+			val |= ((uint64_t) (nibble & 0x7f)) << shift;
+			shift += 7;
 
-		if((nibble & 0x80) > 0)
-			break;
+			if((nibble & 0x80) > 0)
+				break;
+		}
 	}
 
 	if(nbytes) // Can be NULL
@@ -461,7 +727,8 @@ uint64_t reader_vbyte(Reader* r, size_t* nbytes) {
 	return val;
 }
 
-uint64_t reader_eliasdelta(Reader* r) {
+// Decoding of large values, that do not fit into a single word.
+static uint64_t eliasdelta_bitwise(Reader* r) {
 	int len = 1;
 	int lenoflen = 0;
 
@@ -484,3 +751,42 @@ uint64_t reader_eliasdelta(Reader* r) {
 
 	return --n; // decrement by 1 to decode 0
 }
+
+uint64_t reader_eliasdelta(Reader* r) {
+	uint64_t w = peek64(r);
+
+	// The code consists of lenoflen zeros, len with lenoflen + 1 bits and the len - 1 lower bits of the value.
+	if(likely(w)) {
+		int lenoflen = __builtin_clzll(w);
+		int lenbits = 2 * lenoflen + 1;
+
+		if(lenbits <= 64) {
+			uint64_t len = w >> (64 - lenbits);
+			int bits = lenbits + len - 1;
+
+			if(bits <= 64) {
+				check_remaining(r, bits);
+				r->bitpos += bits;
+
+				uint64_t n = 1;
+				if(len > 1)
+					n = (n << (len - 1)) | ((w << lenbits) >> (64 - (len - 1)));
+
+				return --n; // decrement by 1 to decode 0
+			}
+		}
+	}
+
+	return eliasdelta_bitwise(r);
+}
+
+void reader_readwords(Reader* r, uint64_t* words, uint64_t n) {
+	uint64_t i;
+	for(i = 0; i + 64 <= n; i += 64)
+		*words++ = word_reverse(reader_readint(r, 64));
+
+	if(i < n) {
+		int rem = n - i;
+		*words = word_reverse(reader_readint(r, rem) << (64 - rem));
+	}
+}
@@ -9,50 +9,106 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <constants.h>
 
 typedef uint64_t FileOff;
 
+// Parameters of the block cache, that is used if the file is not mmapped.
+// Values of 0 select the defaults.
+typedef struct {
+	size_t size; // memory budget in bytes
+	size_t block_size; // size of a block in bytes, must be a power of two
+	int shards; // number of independently locked parts
+	int readahead; // number of blocks additionally read after a sequential miss
+} CacheParams;
+
 #ifndef USE_MMAP
-#define CACHE_BLOCK_SIZE 512
-#define CACHE_CAPACITY 256 // 512 * 0.75 * 256 equals around 100kb maximum cache
+#include <pthread.h>
+
 #define BUFFER_SIZE 8128
 
 typedef struct {
 	FileOff block;
 	int list_prev;
 	int list_next;
-	uint8_t data[CACHE_BLOCK_SIZE];
+	int hash_next;
 } CacheElement;
-#endif
 
+// Each shard is a LRU cache of its own with a lock.
+// The blocks are stored in the array `data` at the same index as their element.
 typedef struct {
-	int fd;
+	pthread_mutex_t lock;
 
-#ifdef USE_MMAP
-	uint8_t* mm; // mmap data
-#else
-	int cache_size;
-	CacheElement cache[CACHE_CAPACITY];
+	int capacity; // maximum number of blocks
+	int size;
+	CacheElement* elements;
+	int* buckets; // heads of the hash chains
+	int bucket_mask;
+	uint8_t* data;
 
 	// linked list to store the last used elements
-	int cache_list_head;
-	int cache_list_tail;
+	int list_head;
+	int list_tail;
 
-	uint8_t read_buf[BUFFER_SIZE];
+	uint64_t hits;
+	uint64_t misses;
+} CacheShard;
+#endif
+
+typedef struct {
+	int fd; // -1, if the data are read from a buffer
+
+	// mmap data or the buffer given by the caller,
+	// without mmap only buffers are stored here and files are read with the block cache
+	const uint8_t* mm;
+
+#ifndef USE_MMAP
+	int shard_count;
+	CacheShard* shards;
+
+	size_t block_size;
+	int block_shift;
+	int extent_shift; // consecutive blocks of an extent are stored in the same shard, so they can be read ahead at once
+	int readahead;
+	_Atomic FileOff last_miss; // block of the last cache miss, used to detect sequential reads
 #endif
 
 	FileOff bitlen;
-	FileOff bitpos;
+
+	bool in_memory; // decode the structures into word aligned arrays when they are initialized
 } FileReader;
 
-FileReader* filereader_init(const char* path);
+FileReader* filereader_init(const char* path, const CacheParams* p);
+// The data are read zero-copy from the buffer, so it must stay valid until the file reader is closed.
+FileReader* filereader_init_buffer(const void* data, size_t size);
 void filereader_close(FileReader* fr);
 
+// Returns the number of hits and misses of the block cache, both are 0 if mmap is used.
+void filereader_stats(FileReader* fr, uint64_t* hits, uint64_t* misses);
+
+// A reader holds its own position, so multiple readers can work on the same file reader concurrently.
+// Structures that keep a reader for their lifetime must copy it before seeking, if they are queried in parallel.
 typedef struct {
 	FileReader* r;
 	FileOff bitoff;
+	FileOff bitpos; // absolute position in the file
 } Reader;
 
+// Directory of the sections of a graph file of version 2.
+// A section with the offset 0 does not exist, because the file starts with the magic.
+typedef struct {
+	FileOff off[SECTION_COUNT]; // byte offsets
+	FileOff len[SECTION_COUNT]; // byte lengths
+} Sections;
+
+// Reads the section directory after the magic of the file.
+// Returns -1, if the directory is malformed.
+int sections_read(FileReader* fr, FileOff byte_off, Sections* s);
+
+// Initializes the reader at the start of the section.
+// Returns false, if the section does not exist.
+bool reader_section(FileReader* fr, const Sections* s, int id, Reader* r);
+
 void reader_initf(FileReader* fr, Reader* r, FileOff byte_off);
 void reader_init(const Reader* src, Reader* dst, FileOff byte_off);
 
@@ -62,9 +118,9 @@ void reader_bitpos(Reader* r, FileOff pos);
 /**
  * Only allowed when bitoff == 0.
  * No output parameter needed, because the length is always equals with n.
- * If mmap is used, a pointer to the mmapped data at the given position is returned. Also, the data cannot be NULL and must not be freed.
- * If mmap is not used, this functions always returns the same buffer with the read data so if the data are still needed during the
- * next call of `reader_read`, the data should be copied.
+ * If mmap or a buffer is used, a pointer to the data at the given position is returned. Also, the data cannot be NULL and must not be freed.
+ * Otherwise, this functions always returns the same (thread local) buffer with the read data so if the data are still needed
+ * during the next call of `reader_read`, the data should be copied.
  */
 const uint8_t* reader_read(Reader* r, size_t n);
 bool reader_readbit(Reader* r);
@@ -74,4 +130,9 @@ uint8_t reader_readbyte(Reader* r);
 uint64_t reader_vbyte(Reader* r, size_t* bytes);
 uint64_t reader_eliasdelta(Reader* r);
 
+// Reads n bits into 64 bit words, the i-th bit is stored at the bit i % 64 of the word i / 64.
+// The unused bits of the last word are set to 0.
+void reader_readwords(Reader* r, uint64_t* words, uint64_t n);
+#define reader_in_memory(r) ((r)->r->in_memory)
+
 #endif
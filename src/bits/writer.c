@@ -10,6 +10,9 @@
 #include <constants.h>
 #include <bitarray.h>
 #include <bitsequence.h>
+#include <lines.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef RRR
 // Table only needed for RRR
@@ -33,10 +36,15 @@ int bitwriter_init(BitWriter* w, const char* path) {
 		bitarray_init(&w->data, 0);
 	}
 
+	w->aligned = NULL;
+	w->aligned_len = 0;
+
 	return 0;
 }
 
 int bitwriter_close(BitWriter* w) {
+	free(w->aligned);
+
 	if(w->is_file) {
 		int ret = bitwriter_flush(w);
 
@@ -178,16 +186,76 @@ int bitwriter_write_eliasdelta(BitWriter* w, uint64_t n) {
 	return 0;
 }
 
+// Records the interleaved lines behind the padding byte at `off`.
+static int add_aligned(BitWriter* w, uint64_t off, uint64_t len) {
+	AlignedLines* aligned = realloc(w->aligned, (w->aligned_len + 1) * sizeof(*aligned));
+	if(!aligned)
+		return -1;
+
+	aligned[w->aligned_len++] = (AlignedLines) {off, len};
+	w->aligned = aligned;
+	return 0;
+}
+
+// Moves the lines within their padding, so that they start at a multiple of 64 bytes in the writer.
+// The padding byte is followed by SECTION_ALIGN - 1 bytes of padding in total, before and after the lines.
+static void realign_lines(BitWriter* w, const AlignedLines* a) {
+	uint8_t* data = w->data.data + a->off;
+	int pad = data[0];
+	int target = (SECTION_ALIGN - (a->off + 1) % SECTION_ALIGN) % SECTION_ALIGN;
+	if(pad == target)
+		return;
+
+	memmove(data + 1 + target, data + 1 + pad, a->len);
+	memset(data + 1, 0, target);
+	memset(data + 1 + target + a->len, 0, SECTION_ALIGN - 1 - target);
+	data[0] = target;
+}
+
 int bitwriter_write_bitwriter(BitWriter* restrict w, const BitWriter* restrict src) {
 	assert(!src->is_file);
 	assert(bitarray_len(&src->data) % 8 == 0);
+	assert(src->aligned_len == 0 || bitwriter_len(w) % 8 == 0);
+
+	uint64_t off = bitwriter_bytelen(w);
 
 	if(bitwriter_write_bitarray(w, &src->data) < 0)
 		return -1;
+
+	// the lines are aligned relative to the start of `src`, files are only appended at multiples of 64 bytes
+	assert(!w->is_file || src->aligned_len == 0 || off % SECTION_ALIGN == 0);
+	if(!w->is_file) {
+		for(size_t i = 0; i < src->aligned_len; i++) {
+			if(add_aligned(w, off + src->aligned[i].off, src->aligned[i].len) < 0)
+				return -1;
+			realign_lines(w, &w->aligned[w->aligned_len - 1]);
+		}
+	}
+
 	return bitwriter_flush(w);
 }
 
-static int bitwriter_write_bitsequence_rg(BitWriter* w, const BitArray* b, int factor) {
+// Writes the superblock of every `sample`-th one (or zero), i.e. the last superblock with less ones (zeros) before it.
+static int write_select_hints(BitWriter* w, const Bitsequence* bs, size_t count, int sample, int bits, bool ones) {
+	size_t sb = 0;
+	for(size_t target = 1; target <= count; target += sample) {
+		while(sb + 1 < bs->rs_len) {
+			size_t before = bs->rs[sb + 1];
+			if(!ones)
+				before = (sb + 1) * bs->s - before;
+			if(before >= target)
+				break;
+			sb++;
+		}
+
+		if(bitwriter_write_bits(w, sb, bits) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int bitwriter_write_bitsequence_rg(BitWriter* w, const BitArray* b, int factor, int select_sample) {
 	Bitsequence bs;
 	if(bitsequence_build(&bs, b, factor) < 0)
 		return -1;
@@ -195,15 +263,22 @@ static int bitwriter_write_bitsequence_rg(BitWriter* w, const BitArray* b, int f
 	int res = -1;
 
 	int bits_per_rs = BITS_NEEDED(bs.rs[bs.rs_len - 1]); // precondition: last block of rs contains the max value
+	int bits_per_hint = BITS_NEEDED(bs.rs_len - 1);
 
-	if(bitwriter_write_byte(w, BITSEQUENCE_RG) < 0)
+	if(bitwriter_write_byte(w, select_sample > 0 ? BITSEQUENCE_RG_SELECT : BITSEQUENCE_RG) < 0)
 		goto exit;
 	if(bitwriter_write_vbyte(w, bitarray_len(b)) < 0)
 		goto exit;
-	if(bitwriter_write_vbyte(w, factor) < 0)
+	if(bitwriter_write_vbyte(w, bs.factor) < 0)
 		goto exit;
 	if(bitwriter_write_vbyte(w, bits_per_rs) < 0)
 		goto exit;
+	if(select_sample > 0) {
+		if(bitwriter_write_vbyte(w, select_sample) < 0)
+			goto exit;
+		if(bitwriter_write_vbyte(w, bits_per_hint) < 0)
+			goto exit;
+	}
 	if(bitwriter_write_bitarray(w, b) < 0)
 		goto exit;
 
@@ -213,6 +288,13 @@ static int bitwriter_write_bitsequence_rg(BitWriter* w, const BitArray* b, int f
 				goto exit;
 		}
 	}
+
+	if(select_sample > 0) {
+		if(write_select_hints(w, &bs, bs.ones, select_sample, bits_per_hint, true) < 0)
+			goto exit;
+		if(write_select_hints(w, &bs, bitarray_len(b) - bs.ones, select_sample, bits_per_hint, false) < 0)
+			goto exit;
+	}
 	if(bitwriter_flush(w) < 0)
 		goto exit;
 
@@ -223,6 +305,101 @@ exit:
 	return res;
 }
 
+// writes the words in little endian order, so they can be read directly on little endian machines
+static int write_words(BitWriter* w, const uint64_t* words, uint64_t n) {
+	for(uint64_t i = 0; i < n; i++)
+		if(bitwriter_write_bits(w, __builtin_bswap64(words[i]), 64) < 0)
+			return -1;
+
+	return 0;
+}
+
+// Returns -1 on errors and 1 if the bit sequence has too many ones for the interleaved lines.
+static int bitwriter_write_bitsequence_interleaved(BitWriter* w, const BitArray* b) {
+	uint64_t len = bitarray_len(b);
+	uint64_t nbytes = BYTE_LEN(len);
+
+	// converting the bits to words with the first bit at the lowest bit
+	uint64_t* words = calloc(DIVUP(len, 64) + 1, sizeof(*words));
+	if(!words)
+		return -1;
+
+	uint64_t i;
+	for(i = 0; i < nbytes; i++)
+		words[i / 8] |= ((uint64_t) byte_reverse(b->data[i])) << (8 * (i % 8));
+	if(len % 64)
+		words[len / 64] &= (1ULL << (len % 64)) - 1;
+
+	int res = -1;
+
+	uint64_t* samples0 = NULL;
+	uint64_t* samples1 = NULL;
+	uint64_t* lines = NULL;
+
+	// the ones are counted before building the lines, whose headers would wrap around
+	uint64_t ones = 0;
+	for(i = 0; i < DIVUP(len, 64); i++)
+		ones += POPCNT64(words[i]);
+	if(ones >= LINE_MAX_ONES) {
+		res = 1;
+		goto exit;
+	}
+
+	lines = lines_build(words, len);
+	if(!lines)
+		goto exit;
+
+	uint64_t nlines = lines_count(len);
+
+	samples1 = lines_samples(lines, len, ones, true);
+	samples0 = lines_samples(lines, len, len - ones, false);
+	if(!samples1 || !samples0)
+		goto exit;
+
+	if(bitwriter_write_byte(w, BITSEQUENCE_INTERLEAVED) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, len) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, SELECT_SAMPLE) < 0)
+		goto exit;
+
+	// The lines are aligned to 64 bytes in the writer, the padding before and after them has a fixed length,
+	// so that they can be realigned, when the writer is appended to another one (see `realign_lines`).
+	// Because the sections start at multiples of 64 bytes, the lines are aligned in the file.
+	assert(bitwriter_len(w) % 8 == 0);
+	uint64_t off = bitwriter_bytelen(w);
+	uint64_t nwords = LINE_WORDS * nlines + lines_samples_count(ones) + lines_samples_count(len - ones);
+
+	int pad = (SECTION_ALIGN - (off + 1) % SECTION_ALIGN) % SECTION_ALIGN;
+	if(bitwriter_write_byte(w, pad) < 0)
+		goto exit;
+	for(int j = 0; j < pad; j++)
+		if(bitwriter_write_byte(w, 0) < 0)
+			goto exit;
+
+	if(write_words(w, lines, LINE_WORDS * nlines) < 0)
+		goto exit;
+	if(write_words(w, samples1, lines_samples_count(ones)) < 0)
+		goto exit;
+	if(write_words(w, samples0, lines_samples_count(len - ones)) < 0)
+		goto exit;
+
+	for(int j = pad; j < SECTION_ALIGN - 1; j++)
+		if(bitwriter_write_byte(w, 0) < 0)
+			goto exit;
+	if(!w->is_file && add_aligned(w, off, 8 * nwords) < 0)
+		goto exit;
+
+	res = 0;
+
+exit:
+	free(words);
+	free(lines);
+	free(samples0);
+	free(samples1);
+	return res;
+}
+
 int bitwriter_write_bitsequence(BitWriter* w, const BitArray* b, const BitsequenceParams* params) {
 	size_t len = bitarray_len(b);
 
@@ -241,6 +418,12 @@ int bitwriter_write_bitsequence(BitWriter* w, const BitArray* b, const Bitsequen
 	else if(params->rrr)
 		return bitwriter_write_bitsequence_rrr(w, b, params->factor);
 #endif
-	else
-		return bitwriter_write_bitsequence_rg(w, b, params->factor);
+	else if(params->interleaved) {
+		// falls back to RG, if the number of ones exceeds the header of the lines
+		int res = bitwriter_write_bitsequence_interleaved(w, b);
+		if(res <= 0)
+			return res;
+	}
+
+	return bitwriter_write_bitsequence_rg(w, b, params->factor, params->select_sample);
 }
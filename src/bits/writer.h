@@ -12,6 +12,13 @@
 #include <bitarray.h>
 #include <arith.h>
 
+// Interleaved lines behind their padding byte, which are moved to stay aligned to 64 bytes,
+// if the bitwriter is appended to another one.
+typedef struct {
+	uint64_t off; // byte offset of the padding byte
+	uint64_t len; // byte length of the lines and the samples
+} AlignedLines;
+
 typedef struct {
 	bool is_file; // written to a file
 	union {
@@ -24,6 +31,10 @@ typedef struct {
 		};
 		BitArray data;
 	};
+
+	// the interleaved lines written to the memory
+	AlignedLines* aligned;
+	size_t aligned_len;
 } BitWriter;
 
 // If path is NULL, the data is written to the memory.
@@ -50,6 +61,8 @@ int bitwriter_write_bitwriter(BitWriter* restrict w, const BitWriter* restrict s
 
 typedef struct {
 	int factor;
+	int select_sample; // sampling of the select hints, 0 if no hints are written
+	bool interleaved; // rank counters and data words interleaved in lines of 64 bytes
 #ifdef RRR
 	bool rrr;
 #endif
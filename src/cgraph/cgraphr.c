@@ -25,41 +25,66 @@ typedef struct {
 } GraphReaderImpl;
 
 CGraphR* cgraphr_init(const char* path) {
-	// check if graph file is readable
-	if(access(path, F_OK | R_OK) != 0) {
-		perror(path);
-		return NULL;
-	}
+	return cgraphr_init_params(path, NULL);
+}
 
-	// open the bit reader for the graph file
-	FileReader* fr = filereader_init(path);
-	if(!fr)
-		return NULL;
+// initializes the readers of the grammar and the dictionary of an opened graph file
+// the file reader is closed if an error occurs
+static CGraphR* graph_init(FileReader* fr, const CGraphRParams* p) {
+	fr->in_memory = p && p->in_memory;
+	bool decode_tables = p && p->decode_tables;
+
+	if(fr->bitlen < 8 * MAGIC_GRAPH_LEN)
+		goto err0;
 
-	// initialize the grammar reader with an subreader
 	Reader r;
 	reader_initf(fr, &r, 0);
 
+	GrammarReader* gr;
+	DictionaryReader* dr;
+
 	const uint8_t* magic = reader_read(&r, MAGIC_GRAPH_LEN);
-	if(memcmp(magic, MAGIC_GRAPH, MAGIC_GRAPH_LEN) != 0)
-		goto err0;
+	if(memcmp(magic, MAGIC_GRAPH_V2, MAGIC_GRAPH_V2_LEN) == 0) {
+		Sections sc;
+		if(sections_read(fr, MAGIC_GRAPH_V2_LEN, &sc) < 0)
+			goto err0;
 
-	size_t nbytes;
-	FileOff lengrammar = reader_vbyte(&r, &nbytes);
+		gr = grammar_init_sections(fr, &sc, decode_tables);
+		if(!gr)
+			goto err0;
 
-	FileOff offgrammar = MAGIC_GRAPH_LEN + nbytes;
-	FileOff offdict = offgrammar + lengrammar;
+		if(!reader_section(fr, &sc, SECTION_DICT, &r))
+			goto err1;
 
-	reader_initf(fr, &r, offgrammar);
-	GrammarReader* gr = grammar_init(&r);
-	if(!gr)
+		dr = dictionary_init(&r);
+		if(!dr)
+			goto err1;
+	}
+	else if(memcmp(magic, MAGIC_GRAPH, MAGIC_GRAPH_LEN) == 0) { // version 1 with nested sections
+		size_t nbytes;
+		FileOff lengrammar = reader_vbyte(&r, &nbytes);
+
+		FileOff offgrammar = MAGIC_GRAPH_LEN + nbytes;
+		FileOff offdict = offgrammar + lengrammar;
+
+		// initialize the grammar reader with an subreader
+		reader_initf(fr, &r, offgrammar);
+		gr = grammar_init(&r, decode_tables);
+		if(!gr)
+			goto err0;
+
+		// initialize the dict reader with an subreader
+		reader_initf(fr, &r, offdict);
+		dr = dictionary_init(&r);
+		if(!dr)
+			goto err1;
+	}
+	else
 		goto err0;
 
-	// initialize the dict reader with an subreader
-	reader_initf(fr, &r, offdict);
-	DictionaryReader* dr = dictionary_init(&r);
-	if(!dr)
-		goto err1;
+	size_t nt_cache_size = p && p->nt_cache_size > 0 ? p->nt_cache_size : DEFAULT_NT_CACHE_SIZE;
+	if(nt_cache_size > 0 && grammar_init_cache(gr, nt_cache_size) < 0)
+		goto err2;
 
 	GraphReaderImpl* g = malloc(sizeof(*g));
 	if(!g)
@@ -80,6 +105,42 @@ err0:
 	return NULL;
 }
 
+CGraphR* cgraphr_init_params(const char* path, const CGraphRParams* p) {
+	// check if graph file is readable
+	if(access(path, F_OK | R_OK) != 0) {
+		perror(path);
+		return NULL;
+	}
+
+	CacheParams cp = {0};
+	if(p) {
+		cp.size = p->cache_size;
+		cp.block_size = p->cache_block_size;
+		cp.shards = p->cache_shards;
+		cp.readahead = p->cache_readahead;
+	}
+
+	// open the bit reader for the graph file
+	FileReader* fr = filereader_init(path, &cp);
+	if(!fr)
+		return NULL;
+
+	return graph_init(fr, p);
+}
+
+CGraphR* cgraphr_init_buffer(const void* data, size_t len) {
+	return cgraphr_init_buffer_params(data, len, NULL);
+}
+
+CGraphR* cgraphr_init_buffer_params(const void* data, size_t len, const CGraphRParams* p) {
+	// the buffer is read directly, so the cache parameters are not used
+	FileReader* fr = filereader_init_buffer(data, len);
+	if(!fr)
+		return NULL;
+
+	return graph_init(fr, p);
+}
+
 void cgraphr_destroy(CGraphR* g) {
 	GraphReaderImpl* gi = (GraphReaderImpl*) g;
 
@@ -89,6 +150,16 @@ void cgraphr_destroy(CGraphR* g) {
 	free(gi);
 }
 
+void cgraphr_stats(CGraphR* g, CGraphRStats* s) {
+	GraphReaderImpl* gi = (GraphReaderImpl*) g;
+
+	filereader_stats(gi->r, &s->cache_hits, &s->cache_misses);
+
+	s->nt_cache_hits = s->nt_cache_misses = 0;
+	if(gi->gr->nt_cache)
+		ntcache_stats(gi->gr->nt_cache, &s->nt_cache_hits, &s->nt_cache_misses);
+}
+
 size_t cgraphr_node_count(CGraphR* g) {
 	return ((GraphReaderImpl*) g)->gr->node_count;
 }
@@ -339,6 +410,23 @@ void cgraphr_edges_finish(CGraphEdgeIterator* it) {
 	free(it);
 }
 
+int64_t cgraphr_edges_count(CGraphR* g, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes) {
+	GraphReaderImpl* gi = (GraphReaderImpl*) g;
+
+	for(int i = 0; nodes && i < rank; i++) {
+		if(nodes[i] != CGRAPH_NODES_ALL && (nodes[i] < 0 || nodes[i] >= gi->gr->node_count))
+			return 0; // node does not exist
+	}
+	if(label != CGRAPH_LABELS_ALL && label < 0)
+		return 0;
+
+	uint64_t count;
+	if(grammar_count(gi->gr, rank, label, nodes, &count) < 0)
+		return -1;
+
+	return count;
+}
+
 bool cgraphr_edge_exists(CGraphR* g, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes) {
 	GraphReaderImpl* gi = (GraphReaderImpl*) g;
 
@@ -113,9 +113,18 @@ CGraphW* cgraphw_init() {
 	g->params.max_rank = DEFAULT_MAX_RANK;
 	g->params.monograms = DEFAULT_MONOGRAMS;
 	g->params.factor = DEFAULT_FACTOR;
+	g->params.select_sample = DEFAULT_SELECT_SAMPLE;
+	g->params.interleaved = DEFAULT_INTERLEAVED;
+	g->params.pef_labels = DEFAULT_PEF_LABELS;
+	g->params.k2_hybrid = DEFAULT_K2_HYBRID;
+	g->params.edge_nodes = DEFAULT_EDGE_NODES;
 	g->params.sampling = DEFAULT_SAMPLING;
 	g->params.rle = DEFAULT_RLE;
 	g->params.nt_table = DEFAULT_NT_TABLE;
+	g->params.nt_summary = DEFAULT_NT_SUMMARY;
+	g->params.label_postings = DEFAULT_LABEL_POSTINGS;
+	g->params.nt_counts = DEFAULT_NT_COUNTS;
+	g->params.degrees = DEFAULT_DEGREES;
 #ifdef RRR
 	g->params.rrr = DEFAULT_RRR;
 #endif
@@ -260,6 +269,11 @@ int cgraphw_add_node(CGraphW* g, const char* n) {
 	return 0;
 }
 
+void cgraphw_get_params(CGraphW* g, CGraphCParams* p) {
+	GraphWriterImpl* gi = (GraphWriterImpl*) g;
+	*p = gi->params;
+}
+
 void cgraphw_set_params(CGraphW* g, const CGraphCParams* p) {
 	if(!p)
 		return;
@@ -273,10 +287,20 @@ void cgraphw_set_params(CGraphW* g, const CGraphCParams* p) {
 	gi->params.monograms = p->monograms;
 	if(p->factor > 0)
 		gi->params.factor = p->factor;
+	if(p->select_sample >= 0)
+		gi->params.select_sample = p->select_sample;
+	gi->params.interleaved = p->interleaved;
+	gi->params.pef_labels = p->pef_labels;
+	gi->params.k2_hybrid = p->k2_hybrid;
+	gi->params.edge_nodes = p->edge_nodes;
 	if(p->sampling > 0)
 		gi->params.sampling = p->sampling;
 	gi->params.rle = p->rle;
 	gi->params.nt_table = p->nt_table;
+	gi->params.nt_summary = p->nt_summary;
+	gi->params.label_postings = p->label_postings;
+	gi->params.nt_counts = p->nt_counts;
+	gi->params.degrees = p->degrees;
 #ifdef RRR
 	gi->params.rrr = p->rrr;
 #endif
@@ -471,6 +495,58 @@ err_0:
 	return -1;
 }
 
+// writes zero bytes until the byte length of the writer is aligned to `SECTION_ALIGN`
+static int write_padding(BitWriter* w) {
+	while(bitwriter_bytelen(w) % SECTION_ALIGN != 0)
+		if(bitwriter_write_byte(w, 0) < 0)
+			return -1;
+
+	return 0;
+}
+
+// writes the sections after the magic, prefixed by the section directory
+static int write_sections(BitWriter* w, BitWriter* sections, bool* exists) {
+	uint64_t n = 0;
+	int id;
+	for(id = 0; id < SECTION_COUNT; id++)
+		if(exists[id])
+			n++;
+
+	// the sections start after the directory, which contains the number of sections and 3 values per section
+	uint64_t off = ALIGN(MAGIC_GRAPH_V2_LEN + 8 * (1 + 3 * n), SECTION_ALIGN);
+
+	if(bitwriter_write_bits(w, n, 64) < 0)
+		return -1;
+
+	for(id = 0; id < SECTION_COUNT; id++) {
+		if(!exists[id])
+			continue;
+
+		uint64_t len = bitwriter_bytelen(&sections[id]);
+		if(bitwriter_write_bits(w, id, 64) < 0)
+			return -1;
+		if(bitwriter_write_bits(w, off, 64) < 0)
+			return -1;
+		if(bitwriter_write_bits(w, len, 64) < 0)
+			return -1;
+
+		off = ALIGN(off + len, SECTION_ALIGN);
+	}
+
+	// the sections follow in the order of their ids, each one is preceded by its padding
+	for(id = 0; id < SECTION_COUNT; id++) {
+		if(!exists[id])
+			continue;
+
+		if(write_padding(w) < 0)
+			return -1;
+		if(bitwriter_write_bitwriter(w, &sections[id]) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
 int cgraphw_write(CGraphW* g, const char* path, bool verbose) {
 	GraphWriterImpl* gi = (GraphWriterImpl*) g;
 
@@ -481,52 +557,73 @@ int cgraphw_write(CGraphW* g, const char* path, bool verbose) {
 	if(bitwriter_init(&w, path) < 0)
 		return -1;
 
-	BitWriter w0;
-	bitwriter_init(&w0, NULL);
+	int res = -1;
+
+	// every section is written to the memory first, to determine the offsets of the directory
+	BitWriter sections[SECTION_COUNT];
+	bool exists[SECTION_COUNT] = {0};
+
+	int i;
+	for(i = 0; i < SECTION_COUNT; i++)
+		bitwriter_init(&sections[i], NULL);
+
+	exists[SECTION_GRAMMAR] = exists[SECTION_MATRIX] = true;
+	exists[SECTION_LABELS] = !gi->params.pef_labels;
+	exists[SECTION_LABELS_PEF] = gi->params.pef_labels;
+	exists[SECTION_EDGE_IFS] = exists[SECTION_IFS_TABLE] = exists[SECTION_IFS] = true;
+	exists[SECTION_RULES_TABLE] = exists[SECTION_RULES] = true;
+	exists[SECTION_NT_TABLE] = gi->params.nt_table;
+	exists[SECTION_NT_SUMMARY] = gi->params.nt_table && gi->params.nt_summary;
+	exists[SECTION_LABEL_POSTINGS] = gi->params.nt_table && gi->params.label_postings;
+	exists[SECTION_NT_COUNTS] = gi->params.nt_counts;
+	exists[SECTION_EDGE_NODES_TABLE] = exists[SECTION_EDGE_NODES] = gi->params.edge_nodes;
+	exists[SECTION_DEGREES] = gi->params.degrees;
+	exists[SECTION_DICT] = true;
 
 	BitsequenceParams p;
 	p.factor = gi->params.factor;
+	p.select_sample = gi->params.select_sample;
+	p.interleaved = gi->params.interleaved;
 #ifdef RRR
 	p.rrr = gi->params.rrr;
 #endif
 
-	if(slhr_grammar_write(gi->grammar, gi->nodes, gi->terminals, gi->params.nt_table, &w0, &p) < 0)
-		goto err_0;
-    if (verbose)
-        printf("  Writing magic\n");
-	if(bitwriter_write_bytes(&w, MAGIC_GRAPH, strlen(MAGIC_GRAPH) + 1) < 0)
-		goto err_1;
-    if (verbose)
-        printf("  Writing meta\n");
-	if(bitwriter_write_vbyte(&w, bitwriter_bytelen(&w0)) < 0)
-		goto err_1;
     if (verbose)
         printf("  Writing grammar\n");
-	if(bitwriter_write_bitwriter(&w, &w0) < 0)
-		goto err_1;
-	if(bitwriter_close(&w0) < 0)
-		goto err_0;
-    if (verbose) {
-        printf("  Grammar Size is %lu byte\n", bitwriter_bytelen(&w0));
+	if(slhr_grammar_write(gi->grammar, gi->nodes, gi->terminals, gi->params.nt_table, gi->params.nt_summary, gi->params.pef_labels, gi->params.k2_hybrid, gi->params.edge_nodes, gi->params.degrees, gi->params.label_postings, gi->params.nt_counts, sections, &p) < 0)
+		goto exit;
+    if (verbose)
         printf("  Writing dictionary\n");
+	if(dict_write(gi->dict_ve, &gi->bv, &gi->be, gi->dict_disjunct, gi->params.sampling, gi->params.rle, &sections[SECTION_DICT], &p) < 0)
+		goto exit;
+
+	for(i = 0; i < SECTION_COUNT; i++)
+		if(bitwriter_flush(&sections[i]) < 0)
+			goto exit;
+
+    if (verbose) {
+        uint64_t len = 0;
+        for(i = 0; i < SECTION_COUNT; i++)
+            if(i != SECTION_DICT)
+                len += bitwriter_bytelen(&sections[i]);
+        printf("  Grammar Size is %lu byte\n", len);
+        printf("  Writing magic and sections\n");
     }
-	if(dict_write(gi->dict_ve, &gi->bv, &gi->be, gi->dict_disjunct, gi->params.sampling, gi->params.rle, &w, &p) < 0)
-		goto err_0;
+	if(bitwriter_write_bytes(&w, MAGIC_GRAPH_V2, MAGIC_GRAPH_V2_LEN) < 0)
+		goto exit;
+	if(write_sections(&w, sections, exists) < 0)
+		goto exit;
+
+	res = 0;
+
+exit:
+	for(i = 0; i < SECTION_COUNT; i++)
+		bitwriter_close(&sections[i]);
+
 	if(bitwriter_close(&w) < 0)
 		return -1;
-    if (verbose)
+    if (verbose && res == 0)
         printf("  Writing finished\n");
-		/*
-	FILE *fpt;
-	fpt = fopen("/home/dtkhuat/results/sizes/17_04_24.csv", "a");
-	fprintf(fpt, "%ld\n", bitwriter_bytelen(&w0));
-	fclose(fpt);
-	*/
-	return 0;
 
-err_1:
-	bitwriter_close(&w0);
-err_0:
-	bitwriter_close(&w);
-	return -1;
+	return res;
 }
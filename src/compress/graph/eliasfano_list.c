@@ -22,7 +22,7 @@ static inline void assert_is_sorted(const uint64_t* list, size_t len) {
 
 static inline void set_bits(BitArray* b, size_t off, uint64_t bits, int len) {
 	for(int i = 0; i < len; i++) {
-		uint64_t val = bits & (1 << (len - i - 1));
+		uint64_t val = bits & (1ULL << (len - i - 1));
 		bitarray_set(b, off + i, val > 0);
 	}
 }
@@ -10,16 +10,23 @@
 #include <bitarray.h>
 #include <ringqueue.h>
 #include <arith.h>
+#include <constants.h>
 
 // Do not change!
 #define K 2
-#define K2 ((K) * (K))
 #define NEXT_POW2(n) ((n) == 0 ? 1 : (1 << (__typeof(n)) BIT_LEN(n - 1)))
 
+#define MAX_LEVELS 64
+#define MAX_CHILDREN 64 // maximum number of children of a node and bits of a leaf
+
 typedef struct {
 	size_t width;
 	size_t height;
 	size_t n;
+	bool hybrid;
+	int levels;
+	int split_bits[MAX_LEVELS]; // k of each level as a power of 2
+	int leaf_bits; // size of the leaves as a power of 2
 	BitArray* bits;
 	size_t len_t;
 	size_t len_l;
@@ -38,7 +45,18 @@ static int k2_write_data(K2WriteParams* m, BitWriter* w, const BitsequenceParams
 		goto exit_0;
 	if(bitwriter_write_vbyte(w, m->height) < 0)
 		goto exit_0;
-	if(bitwriter_write_vbyte(w, K) < 0)
+	if(m->hybrid) { // k = 0, followed by the k of each level and the size of the leaves
+		if(bitwriter_write_vbyte(w, 0) < 0)
+			goto exit_0;
+		if(bitwriter_write_vbyte(w, m->levels) < 0)
+			goto exit_0;
+		for(int i = 0; i < m->levels; i++)
+			if(bitwriter_write_vbyte(w, 1 << m->split_bits[i]) < 0)
+				goto exit_0;
+		if(bitwriter_write_vbyte(w, 1 << m->leaf_bits) < 0)
+			goto exit_0;
+	}
+	else if(bitwriter_write_vbyte(w, K) < 0)
 		goto exit_0;
 	if(bitwriter_write_vbyte(w, m->n) < 0)
 		goto exit_0;
@@ -110,7 +128,32 @@ static inline void k2_queue_dequeue(RingQueue* q, size_t* offsetL, size_t* offse
 	free(qe);
 }
 
-int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, BitWriter* w, const BitsequenceParams* p) {
+// Determines the levels of the tree. With `hybrid`, the upper levels use a larger k and the leaves are words.
+static void k2_levels(K2WriteParams* kp, size_t edge_count) {
+	int bits = BIT_LEN(kp->n - 1); // n is a power of 2
+	int i;
+
+	if(!kp->hybrid) {
+		kp->levels = bits - 1;
+		for(i = 0; i < kp->levels; i++)
+			kp->split_bits[i] = 1;
+		kp->leaf_bits = 1;
+		return;
+	}
+
+	kp->leaf_bits = MIN(K2_HYBRID_LEAF_BITS, bits);
+	bits -= kp->leaf_bits;
+
+	// the upper levels have at most as many submatrices as edges
+	int top = MIN(bits / K2_HYBRID_TOP_BITS, (BIT_LEN(edge_count) - 1) / (2 * K2_HYBRID_TOP_BITS));
+	top = MAX(top, 0);
+
+	kp->levels = top + bits - top * K2_HYBRID_TOP_BITS;
+	for(i = 0; i < kp->levels; i++)
+		kp->split_bits[i] = i < top ? K2_HYBRID_TOP_BITS : 1;
+}
+
+int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, bool hybrid, BitWriter* w, const BitsequenceParams* p) {
 	size_t nodes = MAX(MAX(width, height), 2); // minimum is 2 so 1x1-matrices can be k^2-encoded
 
 	// initialize the k2 write params
@@ -118,6 +161,8 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 	kp.width = width;
 	kp.height = height;
 	kp.n = NEXT_POW2(nodes);
+	kp.hybrid = hybrid;
+	k2_levels(&kp, edge_count);
 
 	if(edge_count == 0) { // if no edges exist: do not build the K2 tree
 		kp.bits = NULL;
@@ -131,14 +176,18 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 	for(size_t i = 0; i < edge_count; i++)
 		tedges[i].kval = 0;
 
-	uint64_t counter[K2];
-	uint64_t boundaries[K2 + 1];
-	uint64_t pointer[K2 + 1];
+	uint64_t counter[MAX_CHILDREN];
+	uint64_t boundaries[MAX_CHILDREN + 1];
+	uint64_t pointer[MAX_CHILDREN + 1];
 
-	int maxl = BIT_LEN(nodes - 1) - 1; // max layers
+	// every node has at most as many children as the number of edges
+	size_t len_bits = 8; // reserve an extra byte, because L starts at a full byte
+	for(int i = 0; i < kp.levels; i++)
+		len_bits += edge_count << (2 * kp.split_bits[i]);
+	len_bits += edge_count << (2 * kp.leaf_bits);
 
 	BitArray bits; // initialize the T and L bits
-	if(bitarray_init(&bits, edge_count * maxl * K2 + 8) < 0) // reserve an extra byte, just to be sure
+	if(bitarray_init(&bits, len_bits) < 0)
 		return -1;
 
 	int res = -1;
@@ -152,24 +201,26 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 	// predeclare all variables
 	size_t pos = 0, dequeues = 1, tmpCount, mask, k /* loop variable */,
 		offsetL, offsetR, tempk, tempx, tempy, o;
-	int shift, j;
+	int shift = BIT_LEN(kp.n - 1), j, kl, k2;
 
-	for(int i = 0; i < maxl; i++) {
+	for(int i = 0; i < kp.levels; i++) {
 		tmpCount = 0;
 
-		shift = maxl - i;
+		kl = 1 << kp.split_bits[i];
+		k2 = kl * kl;
+		shift -= kp.split_bits[i];
 		mask = ((size_t) 1 << (shift)) - 1;
 
 		for(k = 0; k < dequeues; k++) {
 			k2_queue_dequeue(&q, &offsetL, &offsetR);
 
-			for(j = 0; j < K2; j++) {
+			for(j = 0; j < k2; j++) {
 				counter[j] = 0;
 				pointer[j] = 0;
 			}
 
 			for(o = offsetL; o < offsetR; o++) {
-				tedges[o].kval = (tedges[o].xval >> shift) + (tedges[o].yval >> shift) * K;
+				tedges[o].kval = (tedges[o].xval >> shift) + (tedges[o].yval >> shift) * kl;
 				tedges[o].xval = tedges[o].xval & mask;
 				tedges[o].yval = tedges[o].yval & mask;
 
@@ -177,7 +228,7 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 			}
 
 			boundaries[0] = offsetL;
-			for(j = 0; j < K2; j++) {
+			for(j = 0; j < k2; j++) {
 				boundaries[j + 1] = boundaries[j] + counter[j];
 				pointer[j] = boundaries[j];
 
@@ -192,7 +243,7 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 				pos++;
 			}
 
-			for(j = 0; j < K2; j++) {
+			for(j = 0; j < k2; j++) {
 				while(pointer[j] < boundaries[j + 1]) {
 					if(tedges[pointer[j]].kval != j) {
 						tempk = tedges[pointer[j]].kval;
@@ -225,28 +276,17 @@ int k2_write(size_t width, size_t height, K2Edge* tedges, size_t edge_count, Bit
 	size_t off_l = BYTE_LEN(len_t);
 	pos = 8 * off_l;
 
+	// the leaves are the remaining submatrices, the cell (x, y) is the bit x + y * kl of a leaf
+	kl = 1 << kp.leaf_bits;
+	k2 = kl * kl;
 	while(!ringqueue_empty(&q)) {
 		k2_queue_dequeue(&q, &offsetL, &offsetR);
 
-		for(j = 0; j < K2; j++)
-			counter[j] = 0;
-
-		for(o = offsetL; o < offsetR; o++) {
-			tedges[o].xval = tedges[o].xval % K;
-			tedges[o].yval = tedges[o].yval % K;
-			tedges[o].kval = tedges[o].xval + tedges[o].yval * K;
-
-			counter[tedges[o].kval]++;
-		}
+		for(o = offsetL; o < offsetR; o++)
+			bitarray_set(&bits, pos + tedges[o].xval % kl + (tedges[o].yval % kl) * kl, true);
 
-		for(j = 0; j < K2; j++) {
-			if(counter[j] > 0)
-				bitarray_set(&bits, pos, true);
-
-			pos++;
-		}
+		pos += k2;
 	}
-
 	kp.bits = &bits;
 	kp.len_t = len_t;
 	kp.len_l = pos - 8 * off_l;
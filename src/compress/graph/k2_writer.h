@@ -7,6 +7,7 @@
 #define K2_WRITER_H
 
 #include <stddef.h>
+#include <stdbool.h>
 #include <writer.h>
 
 typedef struct {
@@ -15,6 +16,7 @@ typedef struct {
 	size_t kval;
 } K2Edge;
 
-int k2_write(size_t width, size_t height, K2Edge* edges, size_t edge_count, BitWriter* w, const BitsequenceParams* p);
+// With `hybrid`, the upper levels of the tree use a larger k and the leaves are submatrices, that fit into a word.
+int k2_write(size_t width, size_t height, K2Edge* edges, size_t edge_count, bool hybrid, BitWriter* w, const BitsequenceParams* p);
 
 #endif
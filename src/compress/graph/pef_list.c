@@ -0,0 +1,136 @@
+/**
+ * @file pef_list.c
+ * @author FR
+ */
+
+#include "pef_list.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <constants.h>
+#include <arith.h>
+
+#define mask_bits(v, n) ((n) < 64 ? (v) & ((1ULL << (n)) - 1) : (v))
+
+static inline int ef_lowbits(uint64_t universe, size_t n) {
+	return universe > n ? (int) ceil(log2((double) universe / n)) : 0;
+}
+
+// Returns the encoding of the chunk with the least number of bits.
+static int chunk_type(const uint64_t* list, size_t n) {
+	uint64_t universe = list[n - 1] - list[0];
+	if(universe == 0)
+		return PEF_RUN;
+
+	bool increasing = true;
+	for(size_t i = 1; i < n && increasing; i++)
+		increasing = list[i] > list[i - 1];
+
+	int l = ef_lowbits(universe, n);
+	uint64_t ef_bits = PEF_LOWBITS_BITS + n * l + n + (universe >> l);
+
+	return increasing && universe + 1 <= ef_bits ? PEF_DENSE : PEF_EF;
+}
+
+static int write_chunk(const uint64_t* list, size_t n, BitWriter* w) {
+	int type = chunk_type(list, n);
+	if(bitwriter_write_bits(w, type, PEF_TYPE_BITS) < 0)
+		return -1;
+
+	uint64_t base = list[0];
+	size_t i;
+
+	switch(type) {
+	case PEF_DENSE: {
+		uint64_t last = 0;
+		for(i = 0; i < n; i++) {
+			uint64_t v = list[i] - base;
+			for(; last < v; last++) // zeros between the values
+				if(bitwriter_write_bit(w, 0) < 0)
+					return -1;
+			if(bitwriter_write_bit(w, 1) < 0)
+				return -1;
+			last = v + 1;
+		}
+		break;
+	}
+	case PEF_EF: {
+		int l = ef_lowbits(list[n - 1] - base, n);
+		if(bitwriter_write_bits(w, l, PEF_LOWBITS_BITS) < 0)
+			return -1;
+
+		for(i = 0; i < n; i++)
+			if(bitwriter_write_bits(w, mask_bits(list[i] - base, l), l) < 0)
+				return -1;
+
+		// the higher bits in unary, a zero for each bucket
+		uint64_t bucket = 0;
+		for(i = 0; i < n; i++) {
+			uint64_t h = (list[i] - base) >> l;
+			for(; bucket < h; bucket++)
+				if(bitwriter_write_bit(w, 0) < 0)
+					return -1;
+			if(bitwriter_write_bit(w, 1) < 0)
+				return -1;
+		}
+		break;
+	}
+	}
+
+	return 0;
+}
+
+int pef_write(const uint64_t* list, size_t n, BitWriter* w) {
+	int res = -1;
+
+	size_t chunks = DIVUP(n, PEF_CHUNK);
+	uint64_t* offsets = malloc(MAX(chunks, 1) * sizeof(*offsets));
+	if(!offsets)
+		return -1;
+
+	BitWriter data;
+	bitwriter_init(&data, NULL);
+
+	size_t c;
+	for(c = 0; c < chunks; c++) {
+		offsets[c] = bitwriter_len(&data);
+		if(write_chunk(list + c * PEF_CHUNK, MIN(PEF_CHUNK, n - c * PEF_CHUNK), &data) < 0)
+			goto exit;
+	}
+
+	uint64_t data_len = bitwriter_len(&data);
+	if(bitwriter_flush(&data) < 0)
+		goto exit;
+
+	int bits_base = n > 0 ? BIT_LEN(list[n - 1]) : 0;
+	int bits_off = BIT_LEN(data_len);
+
+	if(bitwriter_write_vbyte(w, n) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, bits_base) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, bits_off) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, data_len) < 0)
+		goto exit;
+
+	// directory with the first element and the offset of the data of each chunk
+	for(c = 0; c < chunks; c++) {
+		if(bitwriter_write_bits(w, list[c * PEF_CHUNK], bits_base) < 0)
+			goto exit;
+		if(bitwriter_write_bits(w, offsets[c], bits_off) < 0)
+			goto exit;
+	}
+	if(bitwriter_flush(w) < 0)
+		goto exit;
+
+	if(bitwriter_write_bitwriter(w, &data) < 0)
+		goto exit;
+
+	res = 0;
+
+exit:
+	bitwriter_close(&data);
+	free(offsets);
+	return res;
+}
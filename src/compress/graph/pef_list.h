@@ -0,0 +1,15 @@
+/**
+ * @file pef_list.h
+ * @author FR
+ */
+
+#ifndef PEF_LIST_H
+#define PEF_LIST_H
+
+#include <writer.h>
+
+// Writes the sorted list with a partitioned Elias-Fano encoding.
+// The list is split into chunks of PEF_CHUNK elements and each chunk is stored with its smallest encoding.
+int pef_write(const uint64_t* list, size_t n, BitWriter* w);
+
+#endif
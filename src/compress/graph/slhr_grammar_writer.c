@@ -13,6 +13,7 @@
 #include <bitarray.h>
 #include <k2_writer.h>
 #include <eliasfano_list.h>
+#include <pef_list.h>
 
 static int cmp_hedge_cb(const void* v1, const void* v2) {
 	const HEdge* e1 = *((HEdge**) v1);
@@ -126,7 +127,8 @@ static int k2_edgelist_append(K2EdgeList* l, size_t x, size_t y) {
 }
 
 // Create the data to serialize the start symbol
-static int startsymbol_data(const HGraph* g, size_t node_count, K2EdgeList* p_edge_list, uint64_t** p_label_table, size_t** p_indxf_table, Treeset** p_ifs) {
+// If `p_edges` is not NULL, the sorted edges are returned, e.g. to write the node lists of the edges
+static int startsymbol_data(const HGraph* g, size_t node_count, K2EdgeList* p_edge_list, uint64_t** p_label_table, size_t** p_indxf_table, Treeset** p_ifs, HEdge*** p_edges) {
 	// Sort edges
 	size_t edge_count = g->len;
 	HEdge** edges = memdup(g->edges, edge_count * sizeof(HEdge*));
@@ -189,7 +191,10 @@ static int startsymbol_data(const HGraph* g, size_t node_count, K2EdgeList* p_ed
 	// `matrix`, `label_table`, `indxf_table` and `ifs`.
 	// So every other values can be freed
 
-	free(edges);
+	if(p_edges)
+		*p_edges = edges;
+	else
+		free(edges);
 	for(i = 0; i < edge_count; i++)
 		free(edge_ifs[i]);
 	free(edge_ifs);
@@ -225,7 +230,8 @@ err_0:
 	return -1;
 }
 
-static int edge_index_functions_write(size_t* ifs, size_t len, BitWriter* w) {
+// the number of bits per value is written to the header, so the values start at the beginning of `w`
+static int edge_index_functions_write(size_t* ifs, size_t len, BitWriter* header, BitWriter* w) {
 	size_t if_max = 0;
 
 	size_t i;
@@ -234,7 +240,7 @@ static int edge_index_functions_write(size_t* ifs, size_t len, BitWriter* w) {
 			if_max = ifs[i];
 
 	int bits_needed = BITS_NEEDED(if_max);
-	if(bitwriter_write_vbyte(w, bits_needed) < 0)
+	if(bitwriter_write_vbyte(header, bits_needed) < 0)
 		return -1;
 
 	for(i = 0; i < len; i++) {
@@ -261,7 +267,7 @@ static inline int write_index_function(const IndexFunction* indx, BitWriter* w)
 	return 0;
 }
 
-static int index_functions_write(Treeset* ifs_set, BitWriter* w, const BitsequenceParams* p) {
+static int index_functions_write(Treeset* ifs_set, BitWriter* table, BitWriter* w, const BitsequenceParams* p) {
 	size_t ifs_len = treeset_size(ifs_set);
 
 	int res = -1;
@@ -294,16 +300,9 @@ static int index_functions_write(Treeset* ifs_set, BitWriter* w, const Bitsequen
 	for(i = 1; i < ifs_len; i++)
 		offsets[i] = offsets[i - 1] + bitwriter_len(&ifs[i - 1]);
 
-	BitWriter w0;
-	bitwriter_init(&w0, NULL);
-
-	if(eliasfano_write(offsets, ifs_len, &w0, p) < 0)
+	if(eliasfano_write(offsets, ifs_len, table, p) < 0)
 		goto exit_2;
 
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w0)) < 0)
-		goto exit_2;
-	if(bitwriter_write_bitwriter(w, &w0) < 0)
-		goto exit_2;
 	for(i = 0; i < ifs_len; i++) {
 		if(bitwriter_write_bitarray(w, &ifs[i].data) < 0) // not with `bitwriter_write_bitwriter` to prevent flushing
 			goto exit_2;
@@ -314,7 +313,6 @@ static int index_functions_write(Treeset* ifs_set, BitWriter* w, const Bitsequen
 	res = 0;
 
 exit_2:
-	bitwriter_close(&w0);
 	free(offsets);
 exit_1:
 	for(i = 0; i < ifs_len; i++) // close all bitwriters
@@ -325,61 +323,108 @@ exit_0:
 	return res;
 }
 
-static int slhr_grammar_write_startsymbol(const HGraph* g, size_t node_count, BitWriter* w, const BitsequenceParams* p) {
+// The nodes of each edge in the order of the index function, so the edges are decoded without the incidence matrix.
+// The offsets of the edges are written with Elias-Fano to `table` and the node ids with a fixed width to `w`.
+static int edge_nodes_write(HEdge** edges, size_t edge_count, size_t node_count, BitWriter* table, BitWriter* w, const BitsequenceParams* p) {
+	uint64_t* offsets = malloc((edge_count + 1) * sizeof(*offsets));
+	if(!offsets)
+		return -1;
+
+	int res = -1;
+
+	offsets[0] = 0;
+	size_t i;
+	for(i = 0; i < edge_count; i++)
+		offsets[i + 1] = offsets[i] + edges[i]->rank;
+
+	if(eliasfano_write(offsets, edge_count + 1, table, p) < 0)
+		goto exit;
+
+	int bits = BITS_NEEDED(node_count > 0 ? node_count - 1 : 0);
+	if(bitwriter_write_vbyte(w, bits) < 0)
+		goto exit;
+
+	// the nodes of an edge are already in the order of its index function
+	for(i = 0; i < edge_count; i++)
+		for(size_t j = 0; j < edges[i]->rank; j++)
+			if(bitwriter_write_bits(w, edges[i]->nodes[j], bits) < 0)
+				goto exit;
+
+	res = 0;
+
+exit:
+	free(offsets);
+	return res;
+}
+
+// writes the prefix sums of the degrees of the nodes, i.e. the number of edges of the start symbol adjacent to each node
+// the cells of an edge are appended together, so a node occurring several times in an edge is counted once
+static int degrees_write(const K2EdgeList* edges, size_t node_count, BitWriter* w, const BitsequenceParams* p) {
+	uint64_t* sums = calloc(node_count + 1, sizeof(*sums));
+	if(!sums)
+		return -1;
+
+	size_t first = 0; // first cell of the current edge
+	for(size_t i = 0; i < edges->len; i++) {
+		const K2Edge* c = &edges->data[i];
+		if(c->xval != edges->data[first].xval)
+			first = i;
+
+		bool dup = false;
+		for(size_t j = first; j < i && !dup; j++)
+			dup = edges->data[j].yval == c->yval;
+		if(!dup)
+			sums[c->yval + 1]++;
+	}
+
+	for(size_t v = 0; v < node_count; v++)
+		sums[v + 1] += sums[v];
+
+	int res = eliasfano_write(sums, node_count + 1, w, p);
+	free(sums);
+	return res;
+}
+
+static int slhr_grammar_write_startsymbol(const HGraph* g, size_t node_count, bool pef_labels, bool k2_hybrid, bool edge_nodes, bool degrees, BitWriter* sections, const BitsequenceParams* p) {
 	size_t edge_count = hgraph_len(g);
 
 	K2EdgeList edges;
 	uint64_t* label_table;
 	size_t* indxf_table;
 	Treeset* ifs;
+	HEdge** sorted = NULL;
 
 	// Determine the data
-	if(startsymbol_data(g, node_count, &edges, &label_table, &indxf_table, &ifs) < 0)
+	if(startsymbol_data(g, node_count, &edges, &label_table, &indxf_table, &ifs, edge_nodes ? &sorted : NULL) < 0)
 		return -1;
 
 	int res = -1;
 
-	// initialize the bitwriters to write some types to the memory
-	BitWriter w0, w1, w2;
-	bitwriter_init(&w0, NULL);
-	bitwriter_init(&w1, NULL);
-	bitwriter_init(&w2, NULL);
-
-	// write matrix to memory
-	if(k2_write(edge_count, node_count, edges.data, edges.len, &w0, p) < 0)
-		goto exit;
-	if(eliasfano_write(label_table, edge_count, &w1, p) < 0)
-		goto exit;
-	if(edge_index_functions_write(indxf_table, edge_count, &w2) < 0)
+	// the degrees are determined before the cells are reordered by the k2-tree
+	if(degrees && degrees_write(&edges, node_count, &sections[SECTION_DEGREES], p) < 0)
 		goto exit;
 
-	// write header of the start symbol
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w0)) < 0) // byte length of the matrix
-		goto exit;
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w1)) < 0) // byte length of the labels
-		goto exit;
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w2)) < 0) // index function per edge
+	// every part of the start symbol is written to its own section
+	if(k2_write(edge_count, node_count, edges.data, edges.len, k2_hybrid, &sections[SECTION_MATRIX], p) < 0)
 		goto exit;
-	// length of all index functions not needed because it is the last segment
-
-	if(bitwriter_write_bitwriter(w, &w0) < 0) // matrix
-		goto exit;
-	if(bitwriter_write_bitwriter(w, &w1) < 0) // labels
+	if(pef_labels) {
+		if(pef_write(label_table, edge_count, &sections[SECTION_LABELS_PEF]) < 0)
+			goto exit;
+	}
+	else if(eliasfano_write(label_table, edge_count, &sections[SECTION_LABELS], p) < 0)
 		goto exit;
-	if(bitwriter_write_bitwriter(w, &w2) < 0) // index function per edge
+	if(edge_index_functions_write(indxf_table, edge_count, &sections[SECTION_GRAMMAR], &sections[SECTION_EDGE_IFS]) < 0)
 		goto exit;
-	if(index_functions_write(ifs, w, p) < 0)
+	if(index_functions_write(ifs, &sections[SECTION_IFS_TABLE], &sections[SECTION_IFS], p) < 0)
 		goto exit;
-	if(bitwriter_flush(w) < 0)
+	if(edge_nodes && edge_nodes_write(sorted, edge_count, node_count, &sections[SECTION_EDGE_NODES_TABLE], &sections[SECTION_EDGE_NODES], p) < 0)
 		goto exit;
 
 	res = 0; // success
 
 exit:
-	bitwriter_close(&w0);
-	bitwriter_close(&w1);
-	bitwriter_close(&w2);
-
+	if(sorted)
+		free(sorted);
 	k2_edgelist_destroy(&edges);
 	free(label_table);
 	free(indxf_table);
@@ -408,7 +453,7 @@ static int encode_rule(HGraph* g, BitWriter* w) {
 	return 0;
 }
 
-static int slhr_grammar_write_rules(SLHRGrammar* g, BitWriter* w, const BitsequenceParams* p) {
+static int slhr_grammar_write_rules(SLHRGrammar* g, BitWriter* sections, const BitsequenceParams* p) {
 	size_t nt_count = g->rule_max == 0 ? 0 : (g->rule_max - g->min_nt + 1);
 
 	BitWriter* rules_encoded = malloc(nt_count * sizeof(*rules_encoded));
@@ -441,23 +486,19 @@ static int slhr_grammar_write_rules(SLHRGrammar* g, BitWriter* w, const Bitseque
 			offsets[i] = offsets[i - 1] + bitwriter_len(&rules_encoded[i - 1]);
 	}
 
-	BitWriter w0;
-	bitwriter_init(&w0, NULL);
-
-	if(eliasfano_write(offsets, nt_count, &w0, p) < 0)
+	if(eliasfano_write(offsets, nt_count, &sections[SECTION_RULES_TABLE], p) < 0)
 		goto exit_1;
 
+	BitWriter* header = &sections[SECTION_GRAMMAR];
+
 	uint64_t first_nt = nt_count > 0 ? g->min_nt : slhr_grammar_unused_nt(g);
-	if(bitwriter_write_vbyte(w, first_nt) < 0) // first NT
+	if(bitwriter_write_vbyte(header, first_nt) < 0) // first NT
 		goto exit_1;
-	if(bitwriter_write_vbyte(w, nt_count) < 0) // number of NTs (= number of rules)
-		goto exit_1;
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w0)) < 0)
-		goto exit_1;
-	if(bitwriter_write_bitwriter(w, &w0) < 0)
+	if(bitwriter_write_vbyte(header, nt_count) < 0) // number of NTs (= number of rules)
 		goto exit_1;
 
 	// write rules
+	BitWriter* w = &sections[SECTION_RULES];
 	for(i = 0; i < nt_count; i++) {
 		if(bitwriter_write_bitarray(w, &rules_encoded[i].data) < 0) // bitwriter_write_bitwriter because this function flushes
 			goto exit_1;
@@ -470,7 +511,6 @@ static int slhr_grammar_write_rules(SLHRGrammar* g, BitWriter* w, const Bitseque
 
 exit_1:
 	free(offsets);
-	bitwriter_close(&w0);
 exit_0:
 	for(i = 0; i < nt_count; i++)
 		bitwriter_close(&rules_encoded[i]);
@@ -496,7 +536,75 @@ static void get_terminals(BitArray* table, int nt_count, int terminals, int nt,
 	}
 }
 
-static int slhr_grammar_write_nt_table(SLHRGrammar* g, size_t terminals, BitWriter* w, const BitsequenceParams* p) {
+static int cmp_u64_cb(const void* v1, const void* v2) {
+	return CMP(*(const uint64_t*) v1, *(const uint64_t*) v2);
+}
+
+// Writes the postings of the terminal labels, i.e. the value `label * |E| + e` for each NT edge `e` of the start symbol,
+// whose NT produces an edge with the label. `terminals` contains the terminal labels of each NT in the order of the NTs.
+static int label_postings_write(SLHRGrammar* g, const HGraph* start, size_t nt_count, const K2EdgeList* terminals, BitWriter* w, const BitsequenceParams* p) {
+	// offsets of the terminal labels of each NT
+	size_t* off = calloc(nt_count + 1, sizeof(*off));
+	if(!off)
+		return -1;
+
+	size_t i;
+	for(i = 0; i < terminals->len; i++)
+		off[terminals->data[i].yval + 1]++;
+	for(i = 0; i < nt_count; i++)
+		off[i + 1] += off[i];
+
+	int res = -1;
+	uint64_t* list = NULL;
+	size_t len = 0, cap = 0;
+
+	// the edges are sorted like in the start symbol, so the indices match the indices of the reader
+	size_t edge_count = hgraph_len(start);
+	HEdge** edges = memdup(start->edges, edge_count * sizeof(HEdge*));
+	if(!edges)
+		goto exit_0;
+
+	qsort(edges, edge_count, sizeof(HEdge*), cmp_hedge_cb);
+
+	for(i = 0; i < edge_count; i++) {
+		if(nt_count == 0 || edges[i]->label < g->min_nt)
+			continue;
+
+		size_t nt = edges[i]->label - g->min_nt;
+		for(size_t j = off[nt]; j < off[nt + 1]; j++) {
+			if(len == cap) {
+				cap = !cap ? 1024 : 2 * cap;
+				uint64_t* tmp = realloc(list, cap * sizeof(*list));
+				if(!tmp)
+					goto exit_1;
+				list = tmp;
+			}
+
+			list[len++] = terminals->data[j].xval * edge_count + i;
+		}
+	}
+
+	if(list)
+		qsort(list, len, sizeof(*list), cmp_u64_cb);
+
+	if(bitwriter_write_vbyte(w, edge_count) < 0)
+		goto exit_1;
+	if(eliasfano_write(list, len, w, p) < 0)
+		goto exit_1;
+
+	res = 0;
+
+exit_1:
+	if(list)
+		free(list);
+	free(edges);
+exit_0:
+	free(off);
+	return res;
+}
+
+// With `postings`, the postings of the terminal labels are written additionally with the NTs of the start symbol `start`.
+static int slhr_grammar_write_nt_table(SLHRGrammar* g, size_t terminals, const HGraph* start, BitWriter* postings, BitWriter* w, const BitsequenceParams* p) {
 	size_t nt_count = g->rule_max == 0 ? 0 : (g->rule_max - g->min_nt + 1);
 	size_t table_width = terminals + nt_count;
 
@@ -556,8 +664,12 @@ static int slhr_grammar_write_nt_table(SLHRGrammar* g, size_t terminals, BitWrit
 		}
 	}
 
+	// the postings are written before the cells are reordered by the k2-tree
+	if(postings && label_postings_write(g, start, nt_count, &edges, postings, p) < 0)
+		goto exit_1;
+
 	// write the k2-encoded list of edges
-	if(k2_write(terminals, nt_count, edges.data, edges.len, w, p) < 0)
+	if(k2_write(terminals, nt_count, edges.data, edges.len, false, w, p) < 0)
 		goto exit_1;
 
 	res = 0;
@@ -570,43 +682,298 @@ exit_0:
 	return res;
 }
 
-int slhr_grammar_write(SLHRGrammar* g, size_t node_count, size_t terminals, bool nt_table, BitWriter* w, const BitsequenceParams* params) {
-	BitWriter w0;
-	bitwriter_init(&w0, NULL);
+typedef struct {
+	uint64_t* columns; // sorted columns of the k2-tree of the summaries
+	size_t len;
+	bool done;
+} NTSummary;
+
+static int nt_summary_append(NTSummary* s, size_t* cap, uint64_t v) {
+	if(s->len == *cap) {
+		*cap = !*cap ? 16 : (*cap + (*cap >> 1));
+		uint64_t* columns = realloc(s->columns, *cap * sizeof(*columns));
+		if(!columns)
+			return -1;
 
-	BitWriter w1;
-	bitwriter_init(&w1, NULL);
+		s->columns = columns;
+	}
 
-	if(slhr_grammar_write_startsymbol(slhr_grammar_rule_get(g, START_SYMBOL), node_count, &w0, params) < 0)
-		goto err_0;
-	if(slhr_grammar_write_rules(g, &w1, params) < 0)
-		goto err_0;
+	s->columns[s->len++] = v;
+	return 0;
+}
 
-	if(bitwriter_write_vbyte(w, node_count) < 0)
-		goto err_0;
-	if(bitwriter_write_byte(w, nt_table ? 1 : 0) < 0)
-		goto err_0;
-	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&w0)) < 0)
-		goto err_0;
-	if(nt_table && bitwriter_write_vbyte(w, bitwriter_bytelen(&w1)) < 0) // length of rules only needed if NT-table exists
-		goto err_0;
-	if(bitwriter_write_bitwriter(w, &w0) < 0)
-		goto err_0;
-	if(bitwriter_write_bitwriter(w, &w1) < 0)
-		goto err_0;
+// Determines the summary of the NT with the index `i` from the summaries of the NTs of its rule.
+// The nodes of the edges of a rule are the indices of the nodes of the NT, so the nodes of the summaries are mapped with them.
+static int nt_summary_create(SLHRGrammar* g, int max_rank, NTSummary* summaries, size_t i) {
+	NTSummary* s = &summaries[i];
+	s->done = true; // the grammar is acyclic
 
-	bitwriter_close(&w0);
-	bitwriter_close(&w1);
+	HGraph* rule = slhr_grammar_rule_get(g, g->min_nt + i);
+	size_t cap = 0;
 
-	if(nt_table && slhr_grammar_write_nt_table(g, terminals, w, params) < 0)
-		return -1;
-	if(bitwriter_flush(w) < 0)
+	for(size_t j = 0; j < hgraph_len(rule); j++) {
+		HEdge* e = hgraph_edge_get(rule, j);
+
+		if(slhr_grammar_is_terminal(g, e->label)) {
+			for(size_t p = 0; p < e->rank; p++)
+				if(nt_summary_append(s, &cap, NT_SUMMARY_COLUMN(e->rank, p, e->nodes[p], max_rank)) < 0)
+					return -1;
+			continue;
+		}
+
+		NTSummary* c = &summaries[e->label - g->min_nt];
+		if(!c->done && nt_summary_create(g, max_rank, summaries, e->label - g->min_nt) < 0)
+			return -1;
+
+		for(size_t k = 0; k < c->len; k++) {
+			uint64_t node = c->columns[k] % max_rank;
+			uint64_t v = c->columns[k] - node + e->nodes[node];
+			if(nt_summary_append(s, &cap, v) < 0)
+				return -1;
+		}
+	}
+
+	// sort and remove the duplicates
+	if(s->len > 0) {
+		qsort(s->columns, s->len, sizeof(*s->columns), cmp_u64_cb);
+
+		size_t len = 1;
+		for(size_t k = 1; k < s->len; k++)
+			if(s->columns[k] != s->columns[len - 1])
+				s->columns[len++] = s->columns[k];
+		s->len = len;
+	}
+
+	return 0;
+}
+
+// the number of nodes of a NT and the rank of the edges of the rules are bounded by the maximum rank
+static int rules_max_rank(SLHRGrammar* g, size_t nt_count) {
+	int max_rank = 1;
+	for(size_t i = 0; i < nt_count; i++) {
+		HGraph* rule = slhr_grammar_rule_get(g, g->min_nt + i);
+		max_rank = MAX(max_rank, rule->rank);
+
+		for(size_t j = 0; j < hgraph_len(rule); j++)
+			max_rank = MAX(max_rank, (int) hgraph_edge_get(rule, j)->rank);
+	}
+
+	return max_rank;
+}
+
+static int slhr_grammar_write_nt_summary(SLHRGrammar* g, BitWriter* w, const BitsequenceParams* p) {
+	size_t nt_count = g->rule_max == 0 ? 0 : (g->rule_max - g->min_nt + 1);
+	int max_rank = rules_max_rank(g, nt_count);
+	size_t i, j;
+
+	NTSummary* summaries = calloc(MAX(nt_count, 1), sizeof(*summaries));
+	if(!summaries)
 		return -1;
 
+	int res = -1;
+
+	K2EdgeList edges;
+	k2_edgelist_init(&edges);
+
+	for(i = 0; i < nt_count; i++) {
+		if(!summaries[i].done && nt_summary_create(g, max_rank, summaries, i) < 0)
+			goto exit;
+
+		for(j = 0; j < summaries[i].len; j++)
+			if(k2_edgelist_append(&edges, summaries[i].columns[j], i) < 0)
+				goto exit;
+	}
+
+	if(bitwriter_write_vbyte(w, max_rank) < 0)
+		goto exit;
+	if(k2_write(NT_SUMMARY_COLUMN(max_rank + 1, 0, 0, max_rank), nt_count, edges.data, edges.len, false, w, p) < 0)
+		goto exit;
+
+	res = 0;
+
+exit:
+	k2_edgelist_destroy(&edges);
+	for(i = 0; i < nt_count; i++)
+		if(summaries[i].columns)
+			free(summaries[i].columns);
+	free(summaries);
+
+	return res;
+}
+
+typedef struct {
+	uint64_t key; // `label * (max_rank + 1) + rank` of the terminal edges
+	uint64_t count;
+} NTCountEntry;
+
+typedef struct {
+	NTCountEntry* entries; // sorted by the key
+	size_t len;
+	bool done;
+} NTCount;
+
+static int nt_count_append(NTCount* c, size_t* cap, uint64_t key, uint64_t count) {
+	if(c->len == *cap) {
+		*cap = !*cap ? 16 : (*cap + (*cap >> 1));
+		NTCountEntry* entries = realloc(c->entries, *cap * sizeof(*entries));
+		if(!entries)
+			return -1;
+
+		c->entries = entries;
+	}
+
+	c->entries[c->len].key = key;
+	c->entries[c->len].count = count;
+	c->len++;
 	return 0;
+}
 
-err_0:
-	bitwriter_close(&w0);
-	bitwriter_close(&w1);
-	return -1;
+static int cmp_nt_count_entry_cb(const void* v1, const void* v2) {
+	return CMP(((const NTCountEntry*) v1)->key, ((const NTCountEntry*) v2)->key);
+}
+
+// Determines the number of terminal edges of each label and rank produced by the NT with the index `i`
+// from the counts of the NTs of its rule.
+static int nt_count_create(SLHRGrammar* g, int max_rank, NTCount* counts, size_t i) {
+	NTCount* c = &counts[i];
+	c->done = true; // the grammar is acyclic
+
+	HGraph* rule = slhr_grammar_rule_get(g, g->min_nt + i);
+	size_t cap = 0;
+
+	for(size_t j = 0; j < hgraph_len(rule); j++) {
+		HEdge* e = hgraph_edge_get(rule, j);
+
+		if(slhr_grammar_is_terminal(g, e->label)) {
+			if(nt_count_append(c, &cap, e->label * (max_rank + 1) + e->rank, 1) < 0)
+				return -1;
+			continue;
+		}
+
+		NTCount* d = &counts[e->label - g->min_nt];
+		if(!d->done && nt_count_create(g, max_rank, counts, e->label - g->min_nt) < 0)
+			return -1;
+
+		for(size_t k = 0; k < d->len; k++)
+			if(nt_count_append(c, &cap, d->entries[k].key, d->entries[k].count) < 0)
+				return -1;
+	}
+
+	// sort and add up the counts of the same key
+	if(c->len > 0) {
+		qsort(c->entries, c->len, sizeof(*c->entries), cmp_nt_count_entry_cb);
+
+		size_t len = 1;
+		for(size_t k = 1; k < c->len; k++) {
+			if(c->entries[k].key == c->entries[len - 1].key)
+				c->entries[len - 1].count += c->entries[k].count;
+			else
+				c->entries[len++] = c->entries[k];
+		}
+		c->len = len;
+	}
+
+	return 0;
+}
+
+// Writes the number of terminal edges produced by each NT, grouped by the label and the rank.
+// The maximum rank and the bit widths are followed by the length of the offset table, the offset table
+// and the pairs of the key and the count of each NT.
+static int slhr_grammar_write_nt_counts(SLHRGrammar* g, BitWriter* w, const BitsequenceParams* p) {
+	size_t nt_count = g->rule_max == 0 ? 0 : (g->rule_max - g->min_nt + 1);
+	int max_rank = rules_max_rank(g, nt_count);
+
+	NTCount* counts = calloc(MAX(nt_count, 1), sizeof(*counts));
+	if(!counts)
+		return -1;
+
+	uint64_t* offsets = malloc((nt_count + 1) * sizeof(*offsets));
+	if(!offsets) {
+		free(counts);
+		return -1;
+	}
+
+	int res = -1;
+
+	BitWriter table;
+	bitwriter_init(&table, NULL);
+
+	size_t i, j;
+	uint64_t max_key = 0, max_count = 0;
+
+	offsets[0] = 0;
+	for(i = 0; i < nt_count; i++) {
+		if(!counts[i].done && nt_count_create(g, max_rank, counts, i) < 0)
+			goto exit;
+
+		for(j = 0; j < counts[i].len; j++) {
+			max_key = MAX(max_key, counts[i].entries[j].key);
+			max_count = MAX(max_count, counts[i].entries[j].count);
+		}
+		offsets[i + 1] = offsets[i] + counts[i].len;
+	}
+
+	if(eliasfano_write(offsets, nt_count + 1, &table, p) < 0)
+		goto exit;
+	if(bitwriter_flush(&table) < 0)
+		goto exit;
+
+	int bits_key = BITS_NEEDED(max_key);
+	int bits_count = BITS_NEEDED(max_count);
+
+	if(bitwriter_write_vbyte(w, max_rank) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, bits_key) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, bits_count) < 0)
+		goto exit;
+	if(bitwriter_write_vbyte(w, bitwriter_bytelen(&table)) < 0)
+		goto exit;
+	if(bitwriter_write_bitwriter(w, &table) < 0)
+		goto exit;
+
+	for(i = 0; i < nt_count; i++) {
+		for(j = 0; j < counts[i].len; j++) {
+			if(bitwriter_write_bits(w, counts[i].entries[j].key, bits_key) < 0)
+				goto exit;
+			if(bitwriter_write_bits(w, counts[i].entries[j].count, bits_count) < 0)
+				goto exit;
+		}
+	}
+
+	res = 0;
+
+exit:
+	bitwriter_close(&table);
+	free(offsets);
+	for(i = 0; i < nt_count; i++)
+		if(counts[i].entries)
+			free(counts[i].entries);
+	free(counts);
+
+	return res;
+}
+
+int slhr_grammar_write(SLHRGrammar* g, size_t node_count, size_t terminals, bool nt_table, bool nt_summary, bool pef_labels, bool k2_hybrid, bool edge_nodes, bool degrees, bool label_postings, bool nt_counts, BitWriter* sections, const BitsequenceParams* params) {
+	// the header contains the node count, the flag of the NT table,
+	// the bits per index function id of the start symbol and the first NT and number of rules
+	BitWriter* header = &sections[SECTION_GRAMMAR];
+
+	if(bitwriter_write_vbyte(header, node_count) < 0)
+		return -1;
+	if(bitwriter_write_byte(header, nt_table ? 1 : 0) < 0)
+		return -1;
+
+	if(slhr_grammar_write_startsymbol(slhr_grammar_rule_get(g, START_SYMBOL), node_count, pef_labels, k2_hybrid, edge_nodes, degrees, sections, params) < 0)
+		return -1;
+	if(slhr_grammar_write_rules(g, sections, params) < 0)
+		return -1;
+	if(nt_table && slhr_grammar_write_nt_table(g, terminals, slhr_grammar_rule_get(g, START_SYMBOL), label_postings ? &sections[SECTION_LABEL_POSTINGS] : NULL, &sections[SECTION_NT_TABLE], params) < 0)
+		return -1;
+	if(nt_table && nt_summary && slhr_grammar_write_nt_summary(g, &sections[SECTION_NT_SUMMARY], params) < 0)
+		return -1;
+	if(nt_counts && slhr_grammar_write_nt_counts(g, &sections[SECTION_NT_COUNTS], params) < 0)
+		return -1;
+
+	return 0;
 }
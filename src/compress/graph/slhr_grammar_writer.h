@@ -8,7 +8,17 @@
 
 #include <slhr_grammar.h>
 #include <writer.h>
+#include <constants.h>
 
-int slhr_grammar_write(SLHRGrammar* g, size_t node_count, size_t terminals, bool nt_table, BitWriter* w, const BitsequenceParams* params);
+// Writes the grammar to the sections of the file format version 2.
+// `sections` is indexed by the section ids and contains a bitwriter writing to the memory for each id.
+// With `pef_labels`, the labels of the start symbol are written to SECTION_LABELS_PEF instead of SECTION_LABELS.
+// With `k2_hybrid`, the incidence matrix of the start symbol is written as a hybrid k2-tree.
+// With `nt_summary`, the summaries of the NTs are written together with the NT table to SECTION_NT_SUMMARY.
+// With `edge_nodes`, the nodes of each edge of the start symbol are additionally written to SECTION_EDGE_NODES(_TABLE).
+// With `degrees`, the prefix sums of the degrees of the nodes in the start symbol are written to SECTION_DEGREES.
+// With `label_postings`, the NT edges of the start symbol producing each terminal label are written together with the NT table to SECTION_LABEL_POSTINGS.
+// With `nt_counts`, the number of terminal edges of each label and rank produced by each NT is written to SECTION_NT_COUNTS.
+int slhr_grammar_write(SLHRGrammar* g, size_t node_count, size_t terminals, bool nt_table, bool nt_summary, bool pef_labels, bool k2_hybrid, bool edge_nodes, bool degrees, bool label_postings, bool nt_counts, BitWriter* sections, const BitsequenceParams* params);
 
 #endif
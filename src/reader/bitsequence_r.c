@@ -14,6 +14,7 @@
 #include <panic.h>
 #include <arith.h>
 #include <bitarray.h>
+#include <lines.h>
 
 #define BLOCKW 32
 
@@ -22,12 +23,20 @@
 #include <table.h>
 #endif
 
+// The lines are used, if they are decoded into the memory or the bit sequence is of type interleaved
+#define has_lines(b) ((b)->lines || (b)->type == BITSEQUENCE_INTERLEAVED)
+
+static int decode_lines(BitsequenceReader* b);
+static int init_interleaved(BitsequenceReader* b, Reader* r, FileOff off);
+
 BitsequenceReader* bitsequence_reader_init(Reader* r) {
 	uint8_t t = reader_readbyte(r);
 
 	switch(t) {
 	case BITSEQUENCE_REGULAR:
 	case BITSEQUENCE_RG:
+	case BITSEQUENCE_RG_SELECT:
+	case BITSEQUENCE_INTERLEAVED:
 #ifdef RRR
 	case BITSEQUENCE_RRR:
 #endif
@@ -42,6 +51,10 @@ BitsequenceReader* bitsequence_reader_init(Reader* r) {
 
 	b->r = *r;
 	b->type = t;
+	b->lines = NULL;
+	b->samples0 = NULL;
+	b->samples1 = NULL;
+	b->mapped = false;
 
 	size_t nbytes;
 	b->len = reader_vbyte(r, &nbytes);
@@ -51,13 +64,28 @@ BitsequenceReader* bitsequence_reader_init(Reader* r) {
 	case BITSEQUENCE_REGULAR:
 		b->off = 8 * off;
 		break;
+	case BITSEQUENCE_INTERLEAVED:
+		if(init_interleaved(b, r, off) < 0) {
+			bitsequence_reader_destroy(b);
+			return NULL;
+		}
+		return b;
 	case BITSEQUENCE_RG:
+	case BITSEQUENCE_RG_SELECT:
 		b->factor = reader_vbyte(r, &nbytes);
 		off += nbytes;
 
 		b->bits_per_rs = reader_vbyte(r, &nbytes);
 		off += nbytes;
 
+		if(t == BITSEQUENCE_RG_SELECT) {
+			b->select_sample = reader_vbyte(r, &nbytes);
+			off += nbytes;
+
+			b->bits_per_hint = reader_vbyte(r, &nbytes);
+			off += nbytes;
+		}
+
 		b->off = 8 * off;
 		b->s = BLOCKW * b->factor;
 		b->rs_off = b->off + b->len;
@@ -99,68 +127,411 @@ BitsequenceReader* bitsequence_reader_init(Reader* r) {
 	else
 		b->ones = 0;
 
+	if(t == BITSEQUENCE_RG_SELECT) { // the hints follow the rank samples
+		b->hints1_off = b->rs_off + b->bits_per_rs * (b->len / b->s);
+		b->hints0_off = b->hints1_off + b->bits_per_hint * DIVUP(b->ones, b->select_sample);
+	}
+
+	// the number of ones is limited by the header of the lines
+	if(reader_in_memory(r) && b->ones < LINE_MAX_ONES) {
+		if(decode_lines(b) < 0) {
+			bitsequence_reader_destroy(b);
+			return NULL;
+		}
+	}
+
 	return b;
 }
 
+void bitsequence_reader_destroy(BitsequenceReader* b) {
+	if(!b)
+		return;
+
+	if(!b->mapped) {
+		free((void*) b->lines);
+		free((void*) b->samples0);
+		free((void*) b->samples1);
+	}
+	free(b);
+}
+
+#ifdef RRR
+static void decode_rrr(BitsequenceReader* b, uint64_t* words);
+#endif
+
+static int decode_lines(BitsequenceReader* b) {
+	uint64_t* words = calloc(DIVUP(b->len, 64) + 1, sizeof(*words));
+	if(!words)
+		return -1;
+
 #ifdef RRR
-static uint64_t get_bits(BitsequenceReader* b, FileOff offset, FileOff start, uint8_t length) {
-	if(length == 0)
+	if(b->type == BITSEQUENCE_RRR)
+		decode_rrr(b, words);
+	else
+#endif
+	{
+		Reader r = b->r;
+		reader_bitpos(&r, b->off);
+		reader_readwords(&r, words, b->len);
+	}
+
+	uint64_t* lines = lines_build(words, b->len);
+	free(words);
+	if(!lines)
+		return -1;
+
+	b->lines = lines;
+	b->samples1 = lines_samples(lines, b->len, b->ones, true);
+	b->samples0 = lines_samples(lines, b->len, b->len - b->ones, false);
+	if(!b->samples1 || !b->samples0)
+		return -1;
+
+	return 0;
+}
+
+// Reads `n` little endian words at the bit offset `off` of the bit sequence.
+static inline void read_words(BitsequenceReader* b, FileOff off, uint64_t* words, int n) {
+	Reader r = b->r;
+	reader_bitpos(&r, off);
+
+	const uint8_t* data = reader_read(&r, n * sizeof(uint64_t));
+	memcpy(words, data, n * sizeof(uint64_t));
+
+	for(int i = 0; i < n; i++)
+		words[i] = le64toh(words[i]);
+}
+
+// Copies `n` words of the interleaved bit sequence into the memory.
+static uint64_t* copy_words(BitsequenceReader* b, FileOff off, uint64_t n) {
+	uint64_t* words;
+	if(posix_memalign((void**) &words, LINE_WORDS * sizeof(uint64_t), n * sizeof(uint64_t)) != 0)
+		return NULL;
+
+	for(uint64_t i = 0; i < n; i += LINE_WORDS)
+		read_words(b, off + 64 * i, words + i, MIN(LINE_WORDS, n - i));
+
+	return words;
+}
+
+static int init_interleaved(BitsequenceReader* b, Reader* r, FileOff off) {
+	size_t nbytes;
+	uint64_t sample = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	if(sample != SELECT_SAMPLE) // the samples are only valid with the same sampling
+		return -1;
+
+	// the lines are padded to 64 bytes in the file
+	off += 1 + reader_readbyte(r);
+
+	uint64_t nlines = lines_count(b->len);
+	b->lines_off = 8 * off;
+	b->samples1_off = b->lines_off + 64 * LINE_WORDS * nlines;
+
+	uint64_t h;
+	read_words(b, b->lines_off + 64 * LINE_WORDS * (nlines - 1), &h, 1);
+	b->ones = line_abs(h);
+
+	uint64_t nsamples1 = lines_samples_count(b->ones);
+	uint64_t nsamples0 = lines_samples_count(b->len - b->ones);
+	b->samples0_off = b->samples1_off + 64 * nsamples1;
+
+	const uint8_t* mm = r->r->mm;
+	FileOff start = b->r.bitoff / 8; // byte offset of the bit sequence in the file
+
+	if((start + b->lines_off / 8) % SECTION_ALIGN != 0) // the writer aligns the lines in the file
+		return -1;
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	// the lines are used directly, if the file is mapped to the memory or the buffer is aligned as well
+	if(mm && (uintptr_t) mm % SECTION_ALIGN == 0) {
+		b->lines = (const uint64_t*) (mm + start + b->lines_off / 8);
+		b->samples1 = (const uint64_t*) (mm + start + b->samples1_off / 8);
+		b->samples0 = (const uint64_t*) (mm + start + b->samples0_off / 8);
+		b->mapped = true;
+
 		return 0;
+	}
+#endif
+
+	if(reader_in_memory(r)) {
+		b->lines = copy_words(b, b->lines_off, LINE_WORDS * nlines);
+		b->samples1 = copy_words(b, b->samples1_off, nsamples1);
+		b->samples0 = copy_words(b, b->samples0_off, nsamples0);
+		if(!b->lines || !b->samples1 || !b->samples0)
+			return -1;
+	}
+
+	return 0;
+}
+
+// Returns the line `l`. If the lines are not in the memory, the line is read into `buf`.
+static inline const uint64_t* line_get(BitsequenceReader* b, uint64_t l, uint64_t* buf) {
+	if(b->lines)
+		return b->lines + LINE_WORDS * l;
+
+	read_words(b, b->lines_off + 64 * LINE_WORDS * l, buf, LINE_WORDS);
+	return buf;
+}
+
+static inline uint64_t line_header(BitsequenceReader* b, uint64_t l) {
+	if(b->lines)
+		return b->lines[LINE_WORDS * l];
+
+	uint64_t h;
+	read_words(b, b->lines_off + 64 * LINE_WORDS * l, &h, 1);
+	return h;
+}
+
+static inline uint64_t sample_get(BitsequenceReader* b, bool ones, uint64_t s) {
+	if(b->lines)
+		return (ones ? b->samples1 : b->samples0)[s];
+
+	uint64_t v;
+	read_words(b, (ones ? b->samples1_off : b->samples0_off) + 64 * s, &v, 1);
+	return v;
+}
+
+static inline bool mem_access(BitsequenceReader* b, uint64_t i) {
+	uint64_t buf[LINE_WORDS];
+	const uint64_t* line = line_get(b, i / LINE_BITS, buf);
+
+	uint64_t o = i % LINE_BITS;
+	return (line[1 + o / 64] >> (o % 64)) & 1;
+}
 
-	FileOff pos = offset + start;
-	int off = pos % 8;
-	uint64_t mask = ((uint64_t) 1 << length) - 1;
+// number of ones in the range [0, i)
+static inline uint64_t mem_rank(BitsequenceReader* b, uint64_t i) {
+	uint64_t buf[LINE_WORDS];
+	const uint64_t* line = line_get(b, i / LINE_BITS, buf);
 
-	reader_bitpos(&b->r, 8 * (pos / 8));
+	uint64_t o = i % LINE_BITS;
+	int k = o / 64;
 
-	if(off + length <= 8) // shortcut if bits do not cross the boundaries of bytes
-		return (reader_readbyte(&b->r) >> (8 - off - length)) & mask;
+	uint64_t h = line[0];
+	uint64_t res = line_abs(h) + line_rel(h, k / 2);
+	if(k & 1)
+		res += POPCNT64(line[k]);
+	if(o % 64)
+		res += POPCNT64(line[k + 1] & ((1ULL << (o % 64)) - 1));
 
-	int byte_len = BYTE_LEN(off + length);
-	int shift = 8 * byte_len - length - off;
+	return res;
+}
+
+static uint64_t mem_select(BitsequenceReader* b, uint64_t i, bool ones) {
+	uint64_t s = (i - 1) / SELECT_SAMPLE;
+	uint64_t lv = sample_get(b, ones, s);
+	uint64_t rv = sample_get(b, ones, s + 1);
+
+	// binary search of the last line with less than i ones (zeros) before it
+	while(lv < rv) {
+		uint64_t mid = (lv + rv + 1) / 2;
+		uint64_t before = line_abs(line_header(b, mid));
+		if(!ones)
+			before = mid * LINE_BITS - before;
+
+		if(before < i)
+			lv = mid;
+		else
+			rv = mid - 1;
+	}
+
+	uint64_t buf[LINE_WORDS];
+	const uint64_t* line = line_get(b, lv, buf);
+	uint64_t h = line[0];
+	i -= ones ? line_abs(h) : lv * LINE_BITS - line_abs(h);
+
+	// determine the pair of data words with the relative counters
+	int j = 3;
+	for(; j > 0; j--) {
+		uint64_t rel = line_rel(h, j);
+		if(!ones)
+			rel = 128 * j - rel;
+		if(rel < i)
+			break;
+	}
+	i -= ones ? line_rel(h, j) : 128 * j - line_rel(h, j);
+
+	int k = 2 * j + 1;
+	uint64_t w = ones ? line[k] : ~line[k];
+	int c = POPCNT64(w);
+	if(c < i) {
+		i -= c;
+		w = ones ? line[++k] : ~line[++k];
+	}
 
-	const uint8_t* data = reader_read(&b->r, byte_len);
+	return lv * LINE_BITS + 64 * (k - 1) + select_bit64(w, i - 1);
+}
 
-	uint64_t val = 0;
-	for(int i = 0; i < byte_len; i++)
-		val = val << 8 | (uint64_t) data[i];
+#ifdef RRR
+// reads a field of at most 64 bits
+static inline uint64_t read_field(Reader* r, uint8_t length) {
+	return length ? reader_readint(r, length) : 0;
+}
 
-	return (val >> shift) & mask;
+static inline uint64_t get_bits(BitsequenceReader* b, FileOff offset, FileOff start, uint8_t length) {
+	Reader r = b->r; // local copy, so concurrent queries do not share the position
+	reader_bitpos(&r, offset + start);
+	return read_field(&r, length);
 }
 
 #define get_field(b, off, len, index) get_bits(b, off, (len) * (index), len)
 
+// The block types are read 16 at a time, the first block is stored in the highest bits.
+#define TYPES_PER_WORD (64 / BLOCK_TYPE_BITS)
+#define type_at(types, n, k) (((types) >> (BLOCK_TYPE_BITS * ((n) - 1 - (k)))) & 0xf)
+
+// sum of the block types packed into a word
+static inline uint64_t types_sum(uint64_t types) {
+	types = (types & 0x0f0f0f0f0f0f0f0fULL) + ((types >> 4) & 0x0f0f0f0f0f0f0f0fULL);
+	return (types * 0x0101010101010101ULL) >> 56;
+}
+
+// Adds the number of ones and the class sizes of the blocks [from, to) and returns the type of the block `to`.
+static uint8_t sum_blocks(BitsequenceReader* b, FileOff from, FileOff to, FileOff* ones, FileOff* rank_offset) {
+	Reader r = b->r;
+	reader_bitpos(&r, b->offset_block_types + BLOCK_TYPE_BITS * from);
+
+	for(;;) {
+		int n = MIN(to + 1 - from, TYPES_PER_WORD);
+		uint64_t types = reader_readint(&r, BLOCK_TYPE_BITS * n);
+		from += n;
+
+		uint8_t last = 0;
+		if(from > to) { // the type of the block `to` is read with the others
+			last = types & 0xf;
+			types >>= BLOCK_TYPE_BITS;
+			n--;
+		}
+
+		*ones += types_sum(types);
+		*rank_offset += table_class_sizes(types) - table_class_size(0) * (TYPES_PER_WORD - n); // the unused types are 0
+
+		if(from > to)
+			return last;
+	}
+}
+
 static bool access_rrr(BitsequenceReader* b, uint64_t i) {
 	FileOff block = i / BITS_PER_BLOCK;
 	FileOff super_block = block / b->sample_rate;
 
+	FileOff ones = 0;
 	FileOff rank_offset = get_field(b, b->offset_super_block_ptrs, b->ptr_width, super_block);
-
-	FileOff block_type;
-	for(FileOff k = super_block * b->sample_rate; k < block; k++) {
-		block_type = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, k);
-		rank_offset += table_class_size(block_type);
-	}
-
-	block_type = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, block);
+	uint8_t block_type = sum_blocks(b, super_block * b->sample_rate, block, &ones, &rank_offset);
 	FileOff offset = get_bits(b, b->offset_block_ranks, rank_offset, table_class_size(block_type));
 
 	FileOff mask = 1 << (i % BITS_PER_BLOCK);
 	return (mask & table_short_bitmap(block_type, offset)) != 0;
 }
+
+// decodes all blocks sequentially into words
+static void decode_rrr(BitsequenceReader* b, uint64_t* words) {
+	Reader rt = b->r;
+	reader_bitpos(&rt, b->offset_block_types);
+
+	Reader rr = b->r;
+	reader_bitpos(&rr, b->offset_block_ranks);
+
+	for(FileOff k = 0; k < b->block_type_len; k++) {
+		uint8_t block_type = reader_readint(&rt, BLOCK_TYPE_BITS);
+		uint64_t block = table_short_bitmap(block_type, read_field(&rr, table_class_size(block_type)));
+
+		uint64_t pos = k * BITS_PER_BLOCK;
+		if(pos + BITS_PER_BLOCK > b->len) // the bits after the end of the sequence are not stored
+			block &= (1ULL << (b->len - pos)) - 1;
+
+		words[pos / 64] |= block << (pos % 64);
+		if(pos % 64 + BITS_PER_BLOCK > 64)
+			words[pos / 64 + 1] |= block >> (64 - pos % 64);
+	}
+}
+
+// Returns the position of the i-th one (or zero), starting at the block `pos`.
+// `acc` is the number of ones (or zeros) before the block and `rank_offset` the offset of its class offset.
+static int64_t select_rrr_blocks(BitsequenceReader* b, uint64_t i, bool ones, FileOff pos, FileOff acc, FileOff rank_offset) {
+	Reader r = b->r;
+	reader_bitpos(&r, b->offset_block_types + BLOCK_TYPE_BITS * pos);
+
+	while(pos < b->block_type_len) {
+		int n = MIN(b->block_type_len - pos, TYPES_PER_WORD);
+		uint64_t types = reader_readint(&r, BLOCK_TYPE_BITS * n);
+
+		uint64_t c = types_sum(types);
+		if(!ones)
+			c = BITS_PER_BLOCK * n - c;
+
+		if(acc + c < i) { // skip all blocks of the word
+			acc += c;
+			rank_offset += table_class_sizes(types) - table_class_size(0) * (TYPES_PER_WORD - n);
+			pos += n;
+			continue;
+		}
+
+		uint8_t block_type;
+		for(int k = 0;; k++) {
+			block_type = type_at(types, n, k);
+			c = ones ? block_type : BITS_PER_BLOCK - block_type;
+			if(acc + c >= i)
+				break;
+
+			acc += c;
+			rank_offset += table_class_size(block_type);
+			pos++;
+		}
+
+		uint32_t block = table_short_bitmap(block_type, get_bits(b, b->offset_block_ranks, rank_offset, table_class_size(block_type)));
+		if(!ones)
+			block = ~block & ((1 << BITS_PER_BLOCK) - 1);
+
+		return pos * BITS_PER_BLOCK + select_bit(block, i - acc - 1);
+	}
+
+	return -1;
+}
+
+// decodes the 64 bits from the position `pos`
+static uint64_t word_rrr(BitsequenceReader* b, uint64_t pos) {
+	FileOff block = pos / BITS_PER_BLOCK;
+	FileOff super_block = block / b->sample_rate;
+
+	FileOff ones = 0;
+	FileOff rank_offset = get_field(b, b->offset_super_block_ptrs, b->ptr_width, super_block);
+	sum_blocks(b, super_block * b->sample_rate, block, &ones, &rank_offset);
+
+	Reader rt = b->r;
+	reader_bitpos(&rt, b->offset_block_types + BLOCK_TYPE_BITS * block);
+
+	Reader rr = b->r;
+	reader_bitpos(&rr, b->offset_block_ranks + rank_offset);
+
+	uint64_t word = 0;
+	for(FileOff k = block; k < b->block_type_len && k * BITS_PER_BLOCK < pos + 64; k++) {
+		uint8_t block_type = reader_readint(&rt, BLOCK_TYPE_BITS);
+		uint64_t bits = table_short_bitmap(block_type, read_field(&rr, table_class_size(block_type)));
+
+		int64_t shift = (int64_t) (k * BITS_PER_BLOCK) - (int64_t) pos; // only negative for the first block
+		word |= shift < 0 ? bits >> -shift : bits << shift;
+	}
+
+	return word;
+}
 #endif
 
 bool bitsequence_reader_access(BitsequenceReader* b, uint64_t i) {
 	if(i >= b->len)
 		panic("index %" PRIu64 " exceeds the length %" PRIu64, i, b->len);
 
+	if(has_lines(b))
+		return mem_access(b, i);
 #ifdef RRR
 	if(b->type == BITSEQUENCE_RRR)
 		return access_rrr(b, i);
 #endif
 
-	reader_bitpos(&b->r, b->off + i);
-	return reader_readbit(&b->r);
+	Reader r = b->r;
+	reader_bitpos(&r, b->off + i);
+	return reader_readbit(&r);
 }
 
 uint64_t bitsequence_reader_rank0(BitsequenceReader* b, int64_t i) {
@@ -174,8 +545,9 @@ static uint64_t rs_value(BitsequenceReader* b, int64_t i) {
 	if(i == 0)
 		return 0;
 
-	reader_bitpos(&b->r, b->rs_off + b->bits_per_rs * (i - 1));
-	return reader_readint(&b->r, b->bits_per_rs);
+	Reader r = b->r;
+	reader_bitpos(&r, b->rs_off + b->bits_per_rs * (i - 1));
+	return reader_readint(&r, b->bits_per_rs);
 }
 
 #ifdef RRR
@@ -185,37 +557,7 @@ static uint64_t rank1_rrr(BitsequenceReader* b, uint64_t i) {
 
 	FileOff c_sum = get_field(b, b->offset_sampling, b->sampling_field_bits, super_block);
 	FileOff rank = get_field(b, b->offset_super_block_ptrs, b->ptr_width, super_block);
-
-	FileOff k = super_block * b->sample_rate;
-	FileOff aux;
-
-	if(k % 2 == 1 && k < block) {
-		aux = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, k);
-		c_sum += aux;
-		rank += table_class_size(aux);
-		k++;
-	}
-
-	FileOff a = k / 2;
-
-	int max_block = block > 0 ? block - 1 : 0; // max(block - 1, 0)
-	while(k < max_block) {
-		uint8_t val = get_field(b, b->offset_block_types, 8, a);
-
-		c_sum += (val & 0xf) + (val >> 4);
-		rank += table_class_size(val & 0xf) + table_class_size(val >> 4);
-		a++;
-		k += 2;
-	}
-
-	if(k < block) {
-		aux = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, k);
-		c_sum += aux;
-		rank += table_class_size(aux);
-		k++;
-	}
-
-	FileOff c = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, block);
+	uint8_t c = sum_blocks(b, super_block * b->sample_rate, block, &c_sum, &rank);
 	FileOff offset = get_bits(b, b->offset_block_ranks, rank, table_class_size(c));
 
 	c_sum += POPCNT32(((2 << (i % BITS_PER_BLOCK)) - 1) & table_short_bitmap(c, offset));
@@ -228,6 +570,8 @@ uint64_t bitsequence_reader_rank1(BitsequenceReader* b, int64_t i) {
 		return 0;
 	if(i >= b->len)
 		return b->ones;
+	if(has_lines(b))
+		return mem_rank(b, i + 1);
 #ifdef RRR
 	if(b->type == BITSEQUENCE_RRR)
 		return rank1_rrr(b, i);
@@ -250,10 +594,11 @@ uint64_t bitsequence_reader_rank1(BitsequenceReader* b, int64_t i) {
 
 	if(bit_len) {
 		// set bitpos to first block
-		reader_bitpos(&b->r, b->off + BLOCKW * aux);
+		Reader r = b->r;
+		reader_bitpos(&r, b->off + BLOCKW * aux);
 
 		size_t byte_len = BYTE_LEN(bit_len);
-		const uint8_t* data = reader_read(&b->r, byte_len);
+		const uint8_t* data = reader_read(&r, byte_len);
 
 		int endbits = byte_len * 8 - bit_len;
 
@@ -272,11 +617,12 @@ uint64_t bitsequence_reader_rank1(BitsequenceReader* b, int64_t i) {
 
 // This function always returns the block in big endian order.
 static inline uint32_t block_get(BitsequenceReader* b, FileOff i) {
-	reader_bitpos(&b->r, b->off + i * BLOCKW);
+	Reader r = b->r;
+	reader_bitpos(&r, b->off + i * BLOCKW);
 
 	const uint8_t* data;
 	if(i * BLOCKW + BLOCKW <= b->len) { // check if current block consists of 4 bytes
-		data = reader_read(&b->r, BLOCKW / 8);
+		data = reader_read(&r, BLOCKW / 8);
 
 #if UNALIGN_ACCESS
 		return *((uint32_t*) data);
@@ -294,7 +640,7 @@ static inline uint32_t block_get(BitsequenceReader* b, FileOff i) {
 
 	int byte_len = BYTE_LEN(b->len - i * BLOCKW);
 
-	data = reader_read(&b->r, byte_len);
+	data = reader_read(&r, byte_len);
 
 	uint32_t block = 0; // initialize with zero so the lower uncopied bytes are 0
 	memcpy(&block, data, byte_len);
@@ -352,9 +698,37 @@ static uint64_t select0_blocks(BitsequenceReader* b, uint64_t i, FileOff pos) {
 	return pos;
 }
 
+// Returns the superblock stored as the `j`-th hint, or the last superblock if the hint does not exist.
+static inline FileOff hint_value(BitsequenceReader* b, FileOff off, uint64_t j, uint64_t n) {
+	if(j >= n)
+		return b->len / b->s;
+
+	Reader r = b->r;
+	reader_bitpos(&r, off + b->bits_per_hint * j);
+	return reader_readint(&r, b->bits_per_hint);
+}
+
+// Determines the range of superblocks, which contains the i-th one (or zero), by the select hints.
+// Without hints, the range covers all superblocks.
+static inline void hint_range(BitsequenceReader* b, uint64_t i, bool ones, FileOff* lv, FileOff* rv) {
+	if(b->type != BITSEQUENCE_RG_SELECT) {
+		*lv = 0;
+		*rv = b->len / b->s;
+		return;
+	}
+
+	uint64_t n = DIVUP(ones ? b->ones : b->len - b->ones, b->select_sample);
+	FileOff off = ones ? b->hints1_off : b->hints0_off;
+	uint64_t j = (i - 1) / b->select_sample;
+
+	*lv = hint_value(b, off, j, n);
+	*rv = hint_value(b, off, j + 1, n);
+}
+
 static uint64_t select0_rg(BitsequenceReader* b, uint64_t i) {
-	FileOff lv = 0;
-	FileOff rv = b->len / b->s;
+	FileOff lv, rv;
+	hint_range(b, i, false, &lv, &rv);
+
 	FileOff mid = (lv + rv) / 2;
 	uint64_t rankmid = mid * b->factor * BLOCKW - rs_value(b, mid);
 
@@ -404,48 +778,23 @@ static int64_t select0_rrr(BitsequenceReader* b, uint64_t i) {
 	}
 
 	acc = start * b->sample_rate * BITS_PER_BLOCK - acc;
-	FileOff pos = start * b->sample_rate;
 	FileOff super_block = get_field(b, b->offset_super_block_ptrs, b->ptr_width, start);
 
-	FileOff s;
-	while(pos < b->block_type_len) {
-		s = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, pos);
-		if(acc + BITS_PER_BLOCK - s >= i)
-			break;
-
-		super_block += table_class_size(s);
-		acc += BITS_PER_BLOCK - s;
-		pos++;
-	}
-
-	pos *= BITS_PER_BLOCK;
-
-	while(acc < i) {
-		int block = table_short_bitmap(s, get_bits(b, b->offset_block_ranks, super_block, table_class_size(s)));
-
-		super_block = super_block + table_class_size(s);
-		int count = 0;
-
-		while(acc < i && count < BITS_PER_BLOCK) {
-			pos++;
-			count++;
-			acc += (block & 1) == 0 ? 1 : 0;
-			block /= 2;
-		}
-	}
-
-	return pos - 1;
+	return select_rrr_blocks(b, i, false, start * b->sample_rate, acc, super_block);
 }
 #endif
 
 int64_t bitsequence_reader_select0(BitsequenceReader* b, uint64_t i) {
 	if(i == 0 || i > b->len - b->ones)
 		return -1;
+	if(has_lines(b))
+		return mem_select(b, i, false);
 
 	switch(b->type) {
 	case BITSEQUENCE_REGULAR:
 		return select0_blocks(b, i, 0);
 	case BITSEQUENCE_RG:
+	case BITSEQUENCE_RG_SELECT:
 		return select0_rg(b, i);
 #ifdef RRR
 	case BITSEQUENCE_RRR:
@@ -481,8 +830,9 @@ static uint64_t select1_blocks(BitsequenceReader* b, uint64_t i, FileOff pos) {
 }
 
 static uint64_t select1_rg(BitsequenceReader* b, uint64_t i) {
-	FileOff lv = 0;
-	FileOff rv = b->len / b->s;
+	FileOff lv, rv;
+	hint_range(b, i, true, &lv, &rv);
+
 	FileOff mid = (lv + rv) / 2;
 	uint64_t rankmid = rs_value(b, mid);
 
@@ -531,48 +881,23 @@ static int64_t select1_rrr(BitsequenceReader* b, uint64_t i) {
 	}
 
 	acc = get_field(b, b->offset_sampling, b->sampling_field_bits, start);
-	FileOff pos = start * b->sample_rate;
 	FileOff super_block = get_field(b, b->offset_super_block_ptrs, b->ptr_width, start);
 
-	FileOff s;
-	while(pos < b->block_type_len) {
-		s = get_field(b, b->offset_block_types, BLOCK_TYPE_BITS, pos);
-		if(acc + s >= i)
-			break;
-
-		super_block += table_class_size(s);
-		acc += s;
-		pos++;
-	}
-
-	pos *= BITS_PER_BLOCK;
-
-	while(acc < i) {
-		int block = table_short_bitmap(s, get_bits(b, b->offset_block_ranks, super_block, table_class_size(s)));
-
-		super_block = super_block + table_class_size(s);
-		int count = 0;
-
-		while(acc < i && count < BITS_PER_BLOCK) {
-			pos++;
-			count++;
-			acc += (block & 1) != 0 ? 1 : 0;
-			block /= 2;
-		}
-	}
-
-	return pos - 1;
+	return select_rrr_blocks(b, i, true, start * b->sample_rate, acc, super_block);
 }
 #endif
 
 int64_t bitsequence_reader_select1(BitsequenceReader* b, uint64_t i) {
 	if(i == 0 || i > b->ones)
 		return -1;
+	if(has_lines(b))
+		return mem_select(b, i, true);
 
 	switch(b->type) {
 	case BITSEQUENCE_REGULAR:
 		return select1_blocks(b, i, 0);
 	case BITSEQUENCE_RG:
+	case BITSEQUENCE_RG_SELECT:
 		return select1_rg(b, i);
 #ifdef RRR
 	case BITSEQUENCE_RRR:
@@ -592,3 +917,32 @@ int64_t bitsequence_reader_selectprev1(BitsequenceReader* b, uint64_t i) {
 		return -1;
 	return bitsequence_reader_select1(b, r);
 }
+
+uint64_t bitsequence_reader_word(BitsequenceReader* b, uint64_t k) {
+	uint64_t pos = 64 * k;
+	if(pos >= b->len)
+		return 0;
+
+	uint64_t n = b->len - pos;
+	uint64_t mask = n < 64 ? (1ULL << n) - 1 : ~0ULL; // the bits after the end are not always 0
+
+	if(has_lines(b)) { // the lines consist of whole words
+		uint64_t w = LINE_WORDS * (pos / LINE_BITS) + 1 + (pos % LINE_BITS) / 64;
+		if(!b->lines)
+			read_words(b, b->lines_off + 64 * w, &w, 1);
+		else
+			w = b->lines[w];
+
+		return w & mask;
+	}
+#ifdef RRR
+	if(b->type == BITSEQUENCE_RRR)
+		return word_rrr(b, pos) & mask;
+#endif
+
+	Reader r = b->r;
+	reader_bitpos(&r, b->off + pos);
+
+	n = MIN(n, 64);
+	return word_reverse(reader_readint(&r, n) << (64 - n));
+}
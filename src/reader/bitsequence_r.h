@@ -25,6 +25,17 @@ typedef struct {
 			int bits_per_rs;
 			int s;
 			FileOff rs_off;
+
+			// select hints of RG with select hints
+			int select_sample;
+			int bits_per_hint;
+			FileOff hints1_off; // superblock of every `select_sample`-th one
+			FileOff hints0_off; // superblock of every `select_sample`-th zero
+		};
+		struct { // interleaved
+			FileOff lines_off;
+			FileOff samples1_off;
+			FileOff samples0_off;
 		};
 #ifdef RRR
 		struct { // RRR
@@ -42,10 +53,18 @@ typedef struct {
 	};
 
 	uint64_t ones;
+
+	// In-memory representation, if the file reader is opened in memory
+	// or the interleaved lines can be used directly from the mapped file (NULL otherwise).
+	// The bits are stored in lines of 64 bytes, each with a header word of the rank directory and 7 data words.
+	const uint64_t* lines;
+	const uint64_t* samples0; // line of every SELECT_SAMPLE-th zero
+	const uint64_t* samples1; // line of every SELECT_SAMPLE-th one
+	bool mapped; // the lines and samples point into the mapped file and are not freed
 } BitsequenceReader;
 
 BitsequenceReader* bitsequence_reader_init(Reader* r);
-#define bitsequence_reader_destroy(b) free(b)
+void bitsequence_reader_destroy(BitsequenceReader* b);
 
 #define bitsequence_reader_len(b) ((b)->len)
 #define bitsequence_reader_ones(b) ((b)->ones)
@@ -58,4 +77,7 @@ int64_t bitsequence_reader_select0(BitsequenceReader* b, uint64_t i);
 int64_t bitsequence_reader_select1(BitsequenceReader* b, uint64_t i);
 int64_t bitsequence_reader_selectprev1(BitsequenceReader* b, uint64_t i);
 
+// Returns the bits [64 * k, 64 * k + 64) with the first bit at the lowest bit, the bits after the end are 0.
+uint64_t bitsequence_reader_word(BitsequenceReader* b, uint64_t k);
+
 #endif
@@ -164,6 +164,7 @@ void eliasfano_iter_finish(EliasFanoIterator * it) {
 #include <reader.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <arith.h>
 #include <panic.h>
 #include <bitarray.h>
 #include <bitsequence_r.h>
@@ -195,139 +196,198 @@ EliasFanoReader* eliasfano_init(Reader* r) {
     e->n = n;
     e->lowbits = lowbits;
     e->off_lo = 8 * off;
+    e->lo = NULL;
     e->hi = b;
 
+    if(reader_in_memory(r) && lowbits > 0) {
+        uint64_t bits = ((uint64_t) n) * lowbits;
+
+        e->lo = calloc(DIVUP(bits, 64) + 1, sizeof(uint64_t)); // one additional word, so two words can always be read
+        if(!e->lo) {
+            eliasfano_destroy(e);
+            return NULL;
+        }
+
+        // the values are stored with their least significant bit first
+        reader_init(r, &rt, off);
+        for(uint64_t i = 0, p = 0; i < n; i++, p += lowbits) {
+            uint64_t v = reader_readint(&rt, lowbits);
+
+            e->lo[p / 64] |= v << (p % 64);
+            if(p % 64 + lowbits > 64)
+                e->lo[p / 64 + 1] |= v >> (64 - p % 64);
+        }
+    }
+
     return e;
 }
 
 void eliasfano_destroy(EliasFanoReader* e) {
     bitsequence_reader_destroy(e->hi);
+    free(e->lo);
     free(e);
 }
 
-uint64_t eliasfano_get(EliasFanoReader* e, uint64_t i) {
-    if(i >= e->n)
-        panic("index %" PRIu64 " exceeds the length %zu", i, e->n);
+static inline uint64_t low_get(EliasFanoReader* e, uint64_t i) {
+    if(e->lo) {
+        uint64_t p = ((uint64_t) i) * e->lowbits;
+        uint64_t w = e->lo[p / 64] >> (p % 64);
+        if(p % 64 + e->lowbits > 64)
+            w |= e->lo[p / 64 + 1] << (64 - p % 64);
 
-    uint64_t lval = 0;
+        return e->lowbits < 64 ? w & ((1ULL << e->lowbits) - 1) : w;
+    }
     if(e->lowbits > 0) {
         FileOff off = e->off_lo + ((FileOff) i) * ((FileOff) e->lowbits); // casting to FileOff because of possible overflow
-        reader_bitpos(&e->r, off);
+        Reader r = e->r;
+        reader_bitpos(&r, off);
 
-        lval = reader_readint(&e->r, e->lowbits);
+        return reader_readint(&r, e->lowbits);
     }
 
+    return 0;
+}
+
+uint64_t eliasfano_get(EliasFanoReader* e, uint64_t i) {
+    if(i >= e->n)
+        panic("index %" PRIu64 " exceeds the length %zu", i, e->n);
+
+    uint64_t lval = low_get(e, i);
     uint64_t hval = bitsequence_reader_select1(e->hi, i + 1) - i;
 
     return hval << e->lowbits | lval;
 }
 
-uint64_t eliasfano_binary_search_lowest(EliasFanoReader* k, CGraphEdgeLabel to_search, uint64_t left, uint64_t right)
-{
-    if (eliasfano_get(k, 0) > to_search)
-    { // This case avoids that we reach the lower boarder without possibility of finding a result. Avoids a panic at eliasfano_get.
-        return -1;
+void eliasfano_cursor(EliasFanoReader* e, uint64_t i, EliasFanoCursor* c) {
+    c->e = e;
+    c->i = i;
+
+    if(i == 0) {
+        c->k = 0;
+        c->word = bitsequence_reader_word(e->hi, 0);
     }
-    // BinarySearch on EliasFano to find the lowest occurrence of label.
-    uint64_t mid;
-    while (left <= right) {
-        mid = left + (right - left) / 2;
-        CGraphEdgeLabel l = eliasfano_get(k, mid);
-        if (l == to_search) {
-            if (mid == 0 || (eliasfano_get(k, mid - 1) < l)) {
-                return mid;
-            } else {
-                right = mid - 1;
-            }
-        } else if (l > to_search) {
-            right = mid - 1;
-        } else {
-            left = mid + 1;
-        }
+    else if(i < e->n) {
+        uint64_t p = bitsequence_reader_select1(e->hi, i + 1); // the one of the element i
+        c->k = p / 64;
+        c->word = bitsequence_reader_word(e->hi, c->k) & (~0ULL << (p % 64));
+    }
+    else {
+        c->k = 0;
+        c->word = 0;
     }
-    return -1;
 }
 
-uint64_t eliasfano_binary_search_lowest_or_next_label(EliasFanoReader* k, CGraphEdgeLabel to_search, uint64_t left, uint64_t right)
-{
-    if (eliasfano_get(k, 0) > to_search)
-    { // This case avoids that we reach the lower boarder without possibility of finding a result. Avoids a panic at eliasfano_get.
-        return -1;
+bool eliasfano_cursor_next(EliasFanoCursor* c, uint64_t* v) {
+    EliasFanoReader* e = c->e;
+    if(c->i >= e->n)
+        return false;
+
+    while(!c->word)
+        c->word = bitsequence_reader_word(e->hi, ++c->k);
+
+    uint64_t p = 64 * c->k + __builtin_ctzll(c->word);
+    c->word &= c->word - 1;
+
+    *v = (p - c->i) << e->lowbits | low_get(e, c->i);
+    c->i++;
+    return true;
+}
+
+// Positions the cursor at the first element with a high value of at least h,
+// which follows the h-th zero of the high bits.
+static bool cursor_bucket(EliasFanoReader* e, uint64_t h, EliasFanoCursor* c) {
+    if(h == 0) {
+        eliasfano_cursor(e, 0, c);
+        return e->n > 0;
     }
-    // BinarySearch on EliasFano to find the lowest occurrence of label.
-    uint64_t mid;
-    while (left <= right) {
-        mid = left + (right - left) / 2;
-        CGraphEdgeLabel l = eliasfano_get(k, mid);
-        if (l == to_search) {
-            if (mid == 0 || (eliasfano_get(k, mid - 1) < l)) {
-                return mid;
-            } else {
-                right = mid - 1;
-            }
-        } else if (l > to_search) {
-            right = mid - 1;
-        } else {
-            left = mid + 1;
+
+    int64_t p = bitsequence_reader_select0(e->hi, h);
+    if(p < 0) { // all elements have a smaller high value
+        eliasfano_cursor(e, e->n, c);
+        return false;
+    }
+
+    p++;
+    c->e = e;
+    c->i = p - h;
+    c->k = p / 64;
+    c->word = bitsequence_reader_word(e->hi, c->k) & (~0ULL << (p % 64));
+    return true;
+}
+
+// number of words, that are skipped by scanning before the bucket is searched with select0
+#define SKIP_WORDS 4
+
+bool eliasfano_cursor_next_geq(EliasFanoCursor* c, uint64_t x, uint64_t* v) {
+    EliasFanoReader* e = c->e;
+    uint64_t h = x >> e->lowbits;
+
+    // The high value of an element is the number of zeros before its one.
+    // Words are skipped, if less than h zeros are before their end.
+    for(int j = 0; c->i < e->n; j++) {
+        uint64_t ones = POPCNT64(c->word);
+        if(64 * (c->k + 1) - (c->i + ones) >= h)
+            break;
+
+        if(j == SKIP_WORDS) { // the bucket is far away
+            if(!cursor_bucket(e, h, c))
+                return false;
+            break;
         }
+
+        c->i += ones;
+        c->word = bitsequence_reader_word(e->hi, ++c->k);
     }
-    if (left >= k->n)
-    {
-        return -1;
-    } else {
-        return left; // ID of the edge with the next higher label.
+
+    while(eliasfano_cursor_next(c, v)) {
+        if(*v >= x)
+            return true;
+    }
+
+    return false;
+}
+
+bool eliasfano_successor(EliasFanoReader* e, uint64_t x, EliasFanoCursor* c) {
+    if(!cursor_bucket(e, x >> e->lowbits, c))
+        return false;
+
+    // only the low bits of the elements in the bucket are compared
+    EliasFanoCursor t = *c;
+    uint64_t v;
+    while(eliasfano_cursor_next(&t, &v)) {
+        if(v >= x)
+            return true;
+        *c = t;
     }
+
+    return false;
 }
 
 void eliasfano_iter(EliasFanoReader* k, CGraphEdgeLabel label, CGraphEdgeLabel first_nt, EliasFanoIterator * it) {
-    it->has_next = true;
     it->k = k;
     it->label = label;
     it->first_nt = first_nt;
-    if (label == eliasfano_get(k, 0)) // Quick case for all graphs with only one label and searches for the first label.
-    {
-        it->edge_id = 0;
-        return;
-    }
-    it->edge_id = eliasfano_binary_search_lowest(k, label, 0, k->n-1);
-    if (it->edge_id == -1)
-    {
-        it->edge_id = eliasfano_binary_search_lowest_or_next_label(k, first_nt, 0, k->n-1);
-        if (it->edge_id == -1)
-        {
-            it->has_next = false;
-        }
-    }
+    // If the label does not exist, the iterator continues with the edges of the non-terminals.
+    it->has_next = eliasfano_successor(k, label, &it->c);
 }
 
 static int eliasfano_iter_next_element(EliasFanoIterator * it, uint64_t* v) {
     if (!it->has_next)
         return 0;
-    if (it->edge_id >= it->k->n)
+    uint64_t l;
+    if (!eliasfano_cursor_next(&it->c, &l))
     {
         it->has_next = false;
         return 0;
     }
-    CGraphEdgeLabel l = eliasfano_get(it->k, it->edge_id);
-    if (l != it->label && l < it->first_nt)
+    // After the edges with the label, the edges of the non-terminals follow.
+    if (l != it->label && l < it->first_nt && !eliasfano_cursor_next_geq(&it->c, it->first_nt, &l))
     {
-        it->edge_id = eliasfano_binary_search_lowest_or_next_label(it->k, it->first_nt, it->edge_id, it->k->n-1);
-        if (it->edge_id == -1)
-        {
-            it->has_next = false;
-            return 0;
-        } else {
-            *v = it->edge_id++;
-            return 1;
-        }
-    }
-    if ((l == it->label || l >= it->first_nt))
-    {
-        *v = it->edge_id++;
-        return 1;
+        it->has_next = false;
+        return 0;
     }
-    it->has_next = false;
-    return 0;
+    *v = it->c.i - 1;
+    return 1;
 }
 
 int eliasfano_iter_next(EliasFanoIterator * it, uint64_t* v) {
@@ -15,6 +15,7 @@ typedef struct {
 	size_t n;
 	int lowbits;
 	FileOff off_lo;
+	uint64_t* lo; // low bits decoded into words, if the file reader is opened in memory
 	BitsequenceReader* hi;
 } EliasFanoReader;
 
@@ -23,9 +24,28 @@ void eliasfano_destroy(EliasFanoReader* e);
 
 uint64_t eliasfano_get(EliasFanoReader* e, uint64_t i);
 
+// Cursor to decode the elements sequentially.
+// The high bits are scanned word by word, so only the positioning needs a select.
+typedef struct {
+    EliasFanoReader* e;
+    uint64_t i; // index of the next element
+    uint64_t k; // index of the current word of the high bits
+    uint64_t word; // bits of the current word, that are not consumed yet
+} EliasFanoCursor;
+
+void eliasfano_cursor(EliasFanoReader* e, uint64_t i, EliasFanoCursor* c); // positions the cursor at the element i
+bool eliasfano_cursor_next(EliasFanoCursor* c, uint64_t* v);
+// Skips to the first element with a value of at least x.
+// Returns false, if no such element exists. The index of the element is `c->i - 1` afterwards.
+bool eliasfano_cursor_next_geq(EliasFanoCursor* c, uint64_t x, uint64_t* v);
+
+// Positions the cursor at the first element with a value of at least x, by searching its bucket of the high bits with select0.
+// Returns false, if no such element exists.
+bool eliasfano_successor(EliasFanoReader* e, uint64_t x, EliasFanoCursor* c);
+
 typedef struct {
     EliasFanoReader * k;
-    uint64_t edge_id;
+    EliasFanoCursor c;
     CGraphEdgeLabel label;
     CGraphEdgeLabel first_nt;
     bool has_next;
@@ -210,9 +210,10 @@ bool fmindex_locate(FMIndexReader* f, const uint8_t* p, size_t n, uint64_t* sp,
 
 static inline uint64_t fmi_sampled_get(FMIndexReader* f, uint64_t i) {
 	uint64_t bitoff = 8 * f->sampled_off + f->sampled_n * i;
-	reader_bitpos(&f->r, bitoff);
+	Reader r = f->r;
+	reader_bitpos(&r, bitoff);
 
-	return reader_readint(&f->r, f->sampled_n);
+	return reader_readint(&r, f->sampled_n);
 }
 
 static inline bool fmi_sampled(FMIndexReader* f, uint64_t i) {
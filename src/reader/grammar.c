@@ -13,11 +13,46 @@
 #include <startsymbol.h>
 #include <rules.h>
 #include <k2.h>
-#include <hgraph.h>
-#include <ringqueue.h>
+#include <ntsummary.h>
+#include <ntcounts.h>
 #include <arith.h>
 
-GrammarReader* grammar_init(Reader* r) {
+// creates the grammar reader of the initialized parts
+// all parts are destroyed if an error occurs
+static GrammarReader* grammar_create(uint64_t node_count, StartSymbolReader* start, RulesReader* rules, K2Reader* nt_table, NTSummaryReader* nt_summary, bool decode_tables) {
+	start->nt_table = nt_table;
+	start->nt_summary = nt_summary;
+	start->terminals = rules->first_nt;
+
+	GrammarReader* g = NULL;
+	if(decode_tables && (startsymbol_decode_ifs(start) < 0 || rules_decode(rules) < 0))
+		goto err;
+
+	g = malloc(sizeof(*g));
+	if(!g)
+		goto err;
+
+	g->node_count = node_count;
+	g->start = start;
+	g->rules = rules;
+	g->nt_table = nt_table;
+	g->nt_summary = nt_summary;
+	g->nt_cache = NULL;
+	g->nt_counts = NULL;
+
+	return g;
+
+err:
+	if(nt_table)
+		k2_destroy(nt_table);
+	if(nt_summary)
+		ntsummary_destroy(nt_summary);
+	rules_destroy(rules);
+	startsymbol_destroy(start);
+	return NULL;
+}
+
+GrammarReader* grammar_init(Reader* r, bool decode_tables) {
 	size_t nbytes;
 	uint64_t node_count = reader_vbyte(r, &nbytes);
 	FileOff off = nbytes;
@@ -60,23 +95,94 @@ GrammarReader* grammar_init(Reader* r) {
 	else
 		nt_table = NULL;
 
-	start->nt_table = nt_table;
-	start->terminals = rules->first_nt;
+	return grammar_create(node_count, start, rules, nt_table, NULL, decode_tables);
 
-	GrammarReader* g = malloc(sizeof(*g));
-	if(!g)
-		goto err2;
+err1:
+	rules_destroy(rules);
+err0:
+	startsymbol_destroy(start);
+	return NULL;
+}
 
-	g->node_count = node_count;
-	g->start = start;
-	g->rules = rules;
-	g->nt_table = nt_table;
+GrammarReader* grammar_init_sections(FileReader* fr, const Sections* sc, bool decode_tables) {
+	Reader r;
+	if(!reader_section(fr, sc, SECTION_GRAMMAR, &r))
+		return NULL;
+
+	uint64_t node_count = reader_vbyte(&r, NULL);
+	bool with_nt_table = reader_readbyte(&r);
+	int edge_ifs_n = reader_vbyte(&r, NULL);
+	uint64_t first_nt = reader_vbyte(&r, NULL);
+	uint64_t rule_count = reader_vbyte(&r, NULL);
+
+	Reader rm, rl, re, rt, ri;
+	// the labels are either stored with Elias-Fano or with the partitioned encoding
+	bool labels_pef = reader_section(fr, sc, SECTION_LABELS_PEF, &rl);
+	if(!labels_pef && !reader_section(fr, sc, SECTION_LABELS, &rl))
+		return NULL;
+
+	if(!reader_section(fr, sc, SECTION_MATRIX, &rm) || !reader_section(fr, sc, SECTION_EDGE_IFS, &re)
+			|| !reader_section(fr, sc, SECTION_IFS_TABLE, &rt) || !reader_section(fr, sc, SECTION_IFS, &ri))
+		return NULL;
+
+	StartSymbolReader* start = startsymbol_init_parts(&rm, &rl, labels_pef, edge_ifs_n, &re, &rt, &ri);
+	if(!start)
+		return NULL;
+
+	// the nodes of the edges are optional
+	if(reader_section(fr, sc, SECTION_EDGE_NODES_TABLE, &rt)) {
+		if(!reader_section(fr, sc, SECTION_EDGE_NODES, &ri) || startsymbol_init_edge_nodes(start, &rt, &ri) < 0)
+			goto err0;
+	}
+
+	// the degrees of the nodes are optional
+	if(reader_section(fr, sc, SECTION_DEGREES, &rt) && startsymbol_init_degrees(start, &rt) < 0)
+		goto err0;
+
+	if(!reader_section(fr, sc, SECTION_RULES_TABLE, &rt) || !reader_section(fr, sc, SECTION_RULES, &ri))
+		goto err0;
+
+	RulesReader* rules = rules_init_parts(first_nt, rule_count, &rt, &ri);
+	if(!rules)
+		goto err0;
+
+	K2Reader* nt_table = NULL;
+	NTSummaryReader* nt_summary = NULL;
+	if(with_nt_table) {
+		if(!reader_section(fr, sc, SECTION_NT_TABLE, &rt))
+			goto err1;
+
+		nt_table = k2_init(&rt);
+		if(!nt_table)
+			goto err1;
+
+		// the summaries of the NTs are optional
+		if(reader_section(fr, sc, SECTION_NT_SUMMARY, &rt)) {
+			nt_summary = ntsummary_init(&rt);
+			if(!nt_summary)
+				goto err2;
+		}
+
+		// the postings of the labels are optional
+		if(reader_section(fr, sc, SECTION_LABEL_POSTINGS, &rt) && startsymbol_init_postings(start, &rt, first_nt) < 0)
+			goto err3;
+	}
+
+	GrammarReader* g = grammar_create(node_count, start, rules, nt_table, nt_summary, decode_tables);
+
+	// the counts of the NTs are optional
+	if(g && reader_section(fr, sc, SECTION_NT_COUNTS, &rt) && !(g->nt_counts = ntcounts_init(&rt))) {
+		grammar_destroy(g);
+		return NULL;
+	}
 
 	return g;
 
+err3:
+	if(nt_summary)
+		ntsummary_destroy(nt_summary);
 err2:
-	if(with_nt_table)
-		k2_destroy(nt_table);
+	k2_destroy(nt_table);
 err1:
 	rules_destroy(rules);
 err0:
@@ -89,9 +195,20 @@ void grammar_destroy(GrammarReader* g) {
 	rules_destroy(g->rules);
 	if(g->nt_table)
 		k2_destroy(g->nt_table);
+	if(g->nt_summary)
+		ntsummary_destroy(g->nt_summary);
+	if(g->nt_cache)
+		ntcache_destroy(g->nt_cache);
+	if(g->nt_counts)
+		ntcounts_destroy(g->nt_counts);
 	free(g);
 }
 
+int grammar_init_cache(GrammarReader* g, size_t size) {
+	g->nt_cache = ntcache_init(size);
+	return g->nt_cache ? 0 : -1;
+}
+
 void grammar_neighborhood(GrammarReader* g, bool predicate_query, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes, GrammarNeighborhood* nb) {
 	if(label != CGRAPH_LABELS_ALL && label >= g->rules->first_nt) { // label does not exists as a terminal so no neighbors exists
 		nb->has_next = false;
@@ -105,19 +222,163 @@ void grammar_neighborhood(GrammarReader* g, bool predicate_query, CGraphRank ran
 	nb->g = g;
 
 	startsymbol_neighborhood(g->start, predicate_query, rank, label, nodes, &nb->start);
-	ringqueue_init(&nb->queue, 0);
+	nb->stack.data = NULL;
+	nb->stack.len = nb->stack.cap = 0;
+}
+
+// ensures, that `n` words can be added to the stack
+// the memory of the stack of an iterator is kept until it is finished, so it is reused for every edge of the start symbol
+static int stack_reserve(EdgeStack* s, size_t n) {
+	size_t len = s->len + n;
+	if(len > s->cap) {
+		size_t cap = MAX(2 * s->cap, MAX(len, 256));
+		uint64_t* data = realloc(s->data, cap * sizeof(*data));
+		if(!data)
+			return -1;
+
+		s->data = data;
+		s->cap = cap;
+	}
+
+	return 0;
+}
+
+// reserves an edge with the given rank at the top of the stack and returns the memory of its nodes
+static uint64_t* stack_push(EdgeStack* s, uint64_t label, int rank) {
+	if(stack_reserve(s, rank + 2) < 0)
+		return NULL;
+
+	uint64_t* nodes = s->data + s->len;
+	nodes[rank] = label;
+	nodes[rank + 1] = rank;
+	s->len += rank + 2;
+
+	return nodes;
+}
+
+// removes the top edge of the stack and copies it to `e`
+static void stack_pop(EdgeStack* s, StEdge* e) {
+	const uint64_t* top = s->data + s->len;
+	e->rank = top[-1];
+	e->label = top[-2];
+
+	s->len -= e->rank + 2;
+	memcpy(e->nodes, s->data + s->len, e->rank * sizeof(uint64_t));
 }
 
-static bool hedge_contains(HEdge* e, uint64_t n) {
+// Expands the NT of the edge `e` into its terminal edges with the indices of the nodes of the NT,
+// like they are stored in the cache. The rules are expanded without any checks.
+// return value:
+// >= 0: length of the expansion in `p_data`, which must be freed
+// -1: error occured
+// -2: the expansion exceeds `max_len` words
+static int64_t expand(GrammarReader* g, const StEdge* e, size_t max_len, uint64_t** p_data) {
+	EdgeStack work = {0}, res = {0};
+	int64_t len = -1;
+
+	uint64_t* nodes = stack_push(&work, e->label, e->rank);
+	if(!nodes)
+		goto exit;
+	for(int j = 0; j < e->rank; j++)
+		nodes[j] = j;
+
+	// The edges of a rule are pushed in their order, so the terminal edges are found from the last to the first one.
+	// This is the order of the cache.
+	StEdge cur;
+	StEdge rule[MAX_RULE_SIZE];
+	while(work.len > 0) {
+		stack_pop(&work, &cur);
+
+		if(cur.label < g->rules->first_nt) {
+			if(res.len + cur.rank + 2 > max_len) {
+				len = -2;
+				goto exit;
+			}
+
+			nodes = stack_push(&res, cur.label, cur.rank);
+			if(!nodes)
+				goto exit;
+			memcpy(nodes, cur.nodes, cur.rank * sizeof(uint64_t));
+			continue;
+		}
+
+		size_t rlen = rules_get(g->rules, cur.label, rule);
+		for(size_t i = 0; i < rlen; i++) {
+			nodes = stack_push(&work, rule[i].label, rule[i].rank);
+			if(!nodes)
+				goto exit;
+
+			for(int j = 0; j < rule[i].rank; j++)
+				nodes[j] = cur.nodes[rule[i].nodes[j]];
+		}
+	}
+
+	*p_data = res.data;
+	res.data = NULL;
+	len = res.len;
+
+exit:
+	free(work.data);
+	free(res.data);
+	return len;
+}
+
+// Pushes the terminal edges of the NT edge `e` from the cache to the stack of the iterator.
+// The nodes of the cached edges are the indices of the nodes of the NT, so they are replaced with the nodes of the edge.
+// return value:
+// 1: the edges are pushed
+// 0: the NT is not cached, because its expansion is too large
+// -1: error occured
+static int decompress_cached(GrammarNeighborhood* nb, NTCache* cache, const StEdge* e) {
+	EdgeStack* s = &nb->stack;
+	if(stack_reserve(s, 1) < 0)
+		return -1;
+
+	int64_t len = ntcache_get(cache, e->label, s->data + s->len, s->cap - s->len);
+	if(len == -1) { // expand the NT and add it to the cache
+		uint64_t* data = NULL;
+		len = expand(nb->g, e, cache->max_len, &data);
+		if(len == -1 || ntcache_put(cache, e->label, data, len) < 0 || (len >= 0 && stack_reserve(s, len) < 0)) {
+			free(data);
+			return -1;
+		}
+
+		if(len >= 0)
+			memcpy(s->data + s->len, data, len * sizeof(uint64_t));
+		free(data);
+	}
+	else if(len >= 0 && (size_t) len > s->cap - s->len) { // the stack is too small
+		if(stack_reserve(s, len) < 0)
+			return -1;
+		len = ntcache_copy(cache, e->label, s->data + s->len, s->cap - s->len);
+	}
+
+	if(len < 0) // too large or evicted in the meantime
+		return 0;
+
+	// replace the indices of the nodes from the top to the bottom
+	uint64_t* base = s->data + s->len;
+	for(int64_t pos = len; pos > 0;) {
+		int rank = base[pos - 1];
+		pos -= rank + 2;
+		for(int j = 0; j < rank; j++)
+			base[pos + j] = e->nodes[base[pos + j]];
+	}
+	s->len += len;
+
+	return 1;
+}
+
+static bool stedge_contains(const StEdge* e, uint64_t n) {
 	for(int i = 0; i < e->rank; i++)
 		if(e->nodes[i] == n)
 			return true;
 	return false;
 }
 
-// This function works by only allocating to the stack.
-// No malloc is used so no memory must be freed.
-static int decompress(GrammarNeighborhood* nb, HEdge* e, CGraphEdge* res) {
+// The edges of the rule of a non-terminal are pushed to the stack of the iterator,
+// so the edges are decompressed depth first without allocating memory for each edge.
+static int decompress(GrammarNeighborhood* nb, const StEdge* e, CGraphEdge* res) {
 
 	uint64_t first_nt;
 	if(e->label < (first_nt = nb->g->rules->first_nt)) { // terminal found
@@ -136,14 +397,6 @@ static int decompress(GrammarNeighborhood* nb, HEdge* e, CGraphEdge* res) {
             res->label = e->label;
             memcpy(res->nodes, e->nodes, e->rank * sizeof (CGraphNode));
         }
-		if(e->nodes[0] == 1554779)
-		{
-		printf("(%lu,", e->rank);
-		printf(" %lu,", e->label);
-		for(int i=0; i < e->rank; i++)
-			printf(" %lu,", e->nodes[i]);
-		printf(" ) \n");
-		}
         return 1;
 	}
 
@@ -157,61 +410,49 @@ static int decompress(GrammarNeighborhood* nb, HEdge* e, CGraphEdge* res) {
     // Check if the edge is adjacent to the destination node.
     for (int i=0; i<nb->rank; i++)
     {
-        if(nb->nodes[i] != CGRAPH_NODES_ALL && !hedge_contains(e, nb->nodes[i]))
+        if(nb->nodes[i] != CGRAPH_NODES_ALL && !stedge_contains(e, nb->nodes[i]))
             return 0;
     }
 
+	// Check if the NT produces an edge of the rank with the bound nodes at their positions
+	NTSummaryReader* nt_summary;
+	if((nt_summary = nb->g->nt_summary) && !ntsummary_match(nt_summary, e->label - first_nt, e->nodes, e->rank, nb->rank, nb->nodes))
+		return 0;
+
+	NTCache* nt_cache;
+	if((nt_cache = nb->g->nt_cache)) {
+		int res = decompress_cached(nb, nt_cache, e);
+		if(res != 0)
+			return res < 0 ? -1 : 0;
+	}
+
     StEdge rule[MAX_RULE_SIZE]; // Rule if the non-terminal
 	size_t rlen = rules_get(nb->g->rules, e->label, rule); // load the rule to variable `rule` - already on stack
 
-	for(size_t i = 0; i < rlen; i++) {
+	// the edges are pushed in reverse order, so the first edge of the rule is decompressed first
+	for(size_t i = rlen; i-- > 0;) {
 		StEdge* ei = rule + i;
 
-		HEdge* enew = malloc(hedge_sizeof(ei->rank));
-		if(!enew)
+		uint64_t* nodes = stack_push(&nb->stack, ei->label, ei->rank);
+		if(!nodes)
 			return -1;
 
-		enew->label = ei->label;
-		enew->rank = ei->rank;
-
 		for(int j = 0; j < ei->rank; j++)
-			enew->nodes[j] = e->nodes[ei->nodes[j]];
-
-		// adding all new edges to the queue
-		if(ringqueue_enqueue(&nb->queue, enew) < 0)
-			return -1;
+			nodes[j] = e->nodes[ei->nodes[j]];
 	}
 
 	return 0;
 }
 
-static int grammar_neighborhood_next_enqueue(GrammarNeighborhood* nb) {
-	StEdge e;
-	if(!startsymbol_neighborhood_next(&nb->start, &e))
-		return 0;
-	
-	HEdge* edge = malloc(hedge_sizeof(e.rank));
-	if(!edge)
-		return -1;
-	
-	edge->label = e.label;
-	edge->rank = e.rank;
-	memcpy(edge->nodes, e.nodes, e.rank * sizeof(uint64_t));
-
-	if(ringqueue_enqueue(&nb->queue, edge) < 0)
-		return -1;
-
-	return 1;
-}
-
 int grammar_neighborhood_next(GrammarNeighborhood* nb, CGraphEdge* n) {
 	if(!nb->has_next)
 		return 0;
 
+	StEdge e;
 	for(;;) {
-		if(ringqueue_empty(&nb->queue)) {
+		if(nb->stack.len == 0) {
 			// determine the next edge from the startsymbol
-			switch(grammar_neighborhood_next_enqueue(nb)) {
+			switch(startsymbol_neighborhood_next(&nb->start, &e)) {
 			case 0: // no further neighbors exist
 				grammar_neighborhood_finish(nb);
 				return 0;
@@ -221,22 +462,17 @@ int grammar_neighborhood_next(GrammarNeighborhood* nb, CGraphEdge* n) {
 				return -1;
 			}
 		}
+		else
+			stack_pop(&nb->stack, &e);
 
 		// Do the decompression
-		while(!ringqueue_empty(&nb->queue)) {
-			HEdge* edge = ringqueue_dequeue(&nb->queue);
-
-			int res = decompress(nb, edge, n);
-			free(edge);
-
-			switch(res) {
-			case 0:
-				break;
-			case 1:
-				return 1;
-			default:
-				return -1;
-			}
+		switch(decompress(nb, &e, n)) {
+		case 0:
+			break;
+		case 1:
+			return 1;
+		default:
+			return -1;
 		}
 	}
 }
@@ -244,11 +480,82 @@ int grammar_neighborhood_next(GrammarNeighborhood* nb, CGraphEdge* n) {
 void grammar_neighborhood_finish(GrammarNeighborhood* nb) {
 	if(nb->has_next) {
 		startsymbol_neighborhood_finish(&nb->start);
-
-		while(!ringqueue_empty(&nb->queue))
-			free(ringqueue_dequeue(&nb->queue));
-		ringqueue_destroy(&nb->queue);
+		free(nb->stack.data);
 
 		nb->has_next = false;
 	}
 }
+
+// counts the terminal edges produced by the NT `nt` by expanding its rules, the nodes of the edges are not needed
+// the stack contains the labels of the NTs, that are not expanded yet
+static int count_expand(GrammarReader* g, uint64_t nt, CGraphEdgeLabel label, CGraphRank rank, EdgeStack* s, uint64_t* count) {
+	uint64_t first_nt = g->rules->first_nt;
+	StEdge rule[MAX_RULE_SIZE];
+
+	s->len = 0;
+	if(stack_reserve(s, 1) < 0)
+		return -1;
+	s->data[s->len++] = nt;
+
+	while(s->len > 0) {
+		int rlen = rules_get(g->rules, s->data[--s->len], rule);
+		if(rlen < 0 || stack_reserve(s, rlen) < 0)
+			return -1;
+
+		for(int i = 0; i < rlen; i++) {
+			StEdge* e = rule + i;
+			if(e->label < first_nt) {
+				if((label == CGRAPH_LABELS_ALL || e->label == (uint64_t) label) && (rank == CGRAPH_NODES_ALL || e->rank == rank))
+					(*count)++;
+			}
+			else if(label == CGRAPH_LABELS_ALL || !g->nt_table || k2_get(g->nt_table, e->label - first_nt, label))
+				s->data[s->len++] = e->label;
+		}
+	}
+
+	return 0;
+}
+
+int grammar_count(GrammarReader* g, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes, uint64_t* count) {
+	*count = 0;
+	if(label != CGRAPH_LABELS_ALL && label >= g->rules->first_nt) // label does not exists as a terminal
+		return 0;
+
+	bool bound = false;
+	for(int i = 0; nodes && i < rank && !bound; i++)
+		bound = nodes[i] != CGRAPH_NODES_ALL;
+
+	// the edges adjacent to the bound nodes are decompressed, but not copied
+	if(bound) {
+		GrammarNeighborhood nb;
+		grammar_neighborhood(g, false, rank, label, nodes, &nb);
+
+		int res;
+		while((res = grammar_neighborhood_next(&nb, NULL)) == 1)
+			(*count)++;
+
+		if(res < 0)
+			grammar_neighborhood_finish(&nb);
+		return res;
+	}
+
+	// without bound nodes, the terminal edges of the start symbol are counted by their labels
+	*count = startsymbol_count_terminals(g->start, label, rank);
+
+	EdgeStack s = {0};
+	int res = 0;
+
+	StartSymbolNTIterator it;
+	startsymbol_nt_iter(g->start, label, &it);
+
+	uint64_t nt;
+	while(res == 0 && startsymbol_nt_iter_next(&it, &nt)) {
+		if(g->nt_counts)
+			*count += ntcounts_get(g->nt_counts, nt - g->rules->first_nt, label, rank);
+		else
+			res = count_expand(g, nt, label, rank, &s, count);
+	}
+
+	free(s.data);
+	return res;
+}
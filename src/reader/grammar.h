@@ -10,16 +10,33 @@
 #include <reader.h>
 #include <startsymbol.h>
 #include <rules.h>
+#include <ntsummary.h>
+#include <ntcounts.h>
+#include <ntcache.h>
 
 typedef struct {
 	uint64_t node_count;
 	StartSymbolReader* start;
 	RulesReader* rules;
 	K2Reader* nt_table;
+	NTSummaryReader* nt_summary; // optional summaries of the NTs, only if the NT table exists
+	NTCache* nt_cache; // optional cache of the expanded NTs
+	NTCountsReader* nt_counts; // optional number of the terminal edges produced by each NT
 } GrammarReader;
 
-GrammarReader* grammar_init(Reader* r);
+// With `decode_tables`, the rules and the index functions are decoded into the memory.
+GrammarReader* grammar_init(Reader* r, bool decode_tables);
+GrammarReader* grammar_init_sections(FileReader* fr, const Sections* s, bool decode_tables); // file format version 2
 void grammar_destroy(GrammarReader* g);
+// Adds a cache of the expanded NTs with the memory budget `size` in bytes.
+int grammar_init_cache(GrammarReader* g, size_t size);
+
+// Stack of edges, every edge is stored as its nodes followed by its label and rank, so the top edge is found from the end.
+typedef struct {
+	uint64_t* data;
+	size_t len;
+	size_t cap;
+} EdgeStack;
 
 typedef struct {
 	bool has_next;
@@ -30,7 +47,8 @@ typedef struct {
 
 	GrammarReader* g;
 	StartSymbolNeighborhood start;
-	RingQueue queue;
+
+	EdgeStack stack; // edges, that are not decompressed yet
 } GrammarNeighborhood;
 
 void grammar_neighborhood(GrammarReader* g, bool predicate_query, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes, GrammarNeighborhood* nb);
@@ -42,4 +60,9 @@ void grammar_neighborhood(GrammarReader* g, bool predicate_query, CGraphRank ran
 int grammar_neighborhood_next(GrammarNeighborhood* nb, CGraphEdge* n);
 void grammar_neighborhood_finish(GrammarNeighborhood* nb); // needed if not iterated to the end
 
+// Counts the edges of the neighborhood without copying them to the caller.
+// Without bound nodes, the edges of the NTs are counted with the optional counts of the NTs, else by expanding their rules.
+// Returns -1 if an error occured.
+int grammar_count(GrammarReader* g, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes, uint64_t* count);
+
 #endif
@@ -6,10 +6,37 @@
 #include "k2.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <arith.h>
 #include <reader.h>
 #include <bitsequence_r.h>
-#include <ringqueue.h>
+
+// Computes the positions of the children of the nodes of each level.
+static bool k2_levels(K2Reader* k) {
+	uint64_t start = 0; // first bit of the level d of T
+	uint64_t len = k->levels > 0 ? (uint64_t) k->split[0] * k->split[0] : 0;
+	k->base[0] = 0;
+
+	for(int d = 0; d < k->levels; d++) {
+		uint64_t ones_before = bitsequence_reader_rank1(k->t, (int64_t) start - 1);
+		start += len;
+		if(start > bitsequence_reader_len(k->t))
+			return false;
+
+		uint64_t ones = bitsequence_reader_rank1(k->t, (int64_t) start - 1) - ones_before;
+
+		// the children of the first 1-bit of the level start at the next level
+		if(d + 1 < k->levels) {
+			uint64_t s = (uint64_t) k->split[d + 1] * k->split[d + 1];
+			k->base[d + 1] = start - (ones_before + 1) * s;
+			len = ones * s;
+		}
+		else
+			k->base[d + 1] = -(ones_before + 1);
+	}
+
+	return start == bitsequence_reader_len(k->t);
+}
 
 K2Reader* k2_init(Reader* r) {
 	size_t nbytes;
@@ -22,14 +49,55 @@ K2Reader* k2_init(Reader* r) {
 	uint64_t k = reader_vbyte(r, &nbytes);
 	off += nbytes;
 
+	int levels = 0;
+	uint8_t split[K2_MAX_LEVELS];
+	uint64_t leaf = k;
+
+	// k = 0: the arity of each level and the size of the leaves follow
+	if(k == 0) {
+		levels = reader_vbyte(r, &nbytes);
+		off += nbytes;
+		if(levels > K2_MAX_LEVELS)
+			return NULL;
+
+		for(int d = 0; d < levels; d++) {
+			uint64_t s = reader_vbyte(r, &nbytes);
+			off += nbytes;
+			if(s < 2 || s > UINT8_MAX)
+				return NULL;
+
+			split[d] = s;
+		}
+
+		leaf = reader_vbyte(r, &nbytes);
+		off += nbytes;
+	}
+
 	uint64_t n = reader_vbyte(r, &nbytes);
 	off += nbytes;
 
-	if(!power_of(n, k))
+	if(leaf < 2 || leaf * leaf > 64) // a leaf has to fit into a word
 		return NULL;
 	if(width > n || height > n)
 		return NULL;
 
+	uint64_t size = n;
+	if(k == 0) {
+		for(int d = 0; d < levels; d++) {
+			if(size % split[d] != 0)
+				return NULL;
+			size /= split[d];
+		}
+	}
+	else { // the tree has the same k at every level, the leaves are the submatrices of size k
+		if(!power_of(n, k) || n < k)
+			return NULL;
+		for(; size > k; size /= k)
+			split[levels++] = k;
+	}
+	if(size != leaf)
+		return NULL;
+
 	FileOff len_t = reader_vbyte(r, &nbytes);
 	off += nbytes;
 
@@ -39,8 +107,10 @@ K2Reader* k2_init(Reader* r) {
 
 	k2->width = width;
 	k2->height = height;
-	k2->k = k;
 	k2->n = n;
+	k2->levels = levels;
+	memcpy(k2->split, split, levels * sizeof(*split));
+	k2->leaf = leaf;
 
 	if(len_t > 0) {
 		Reader rt;
@@ -56,9 +126,30 @@ K2Reader* k2_init(Reader* r) {
 
 		k2->t = t;
 		k2->l = rt;
+		k2->lw = NULL;
+
+		if(!k2_levels(k2)) {
+			k2_destroy(k2);
+			return NULL;
+		}
+
+		if(reader_in_memory(r)) {
+			// every 1-bit of the last level of T is a leaf, the root if T is empty
+			uint64_t len_l = (bitsequence_reader_ones(t) + k2->base[levels] + 1) * leaf * leaf;
+
+			k2->lw = malloc(DIVUP(len_l, 64) * sizeof(uint64_t));
+			if(!k2->lw) {
+				k2_destroy(k2);
+				return NULL;
+			}
+
+			reader_readwords(&rt, k2->lw, len_l);
+		}
 	}
-	else
+	else {
 		k2->t = NULL; // k2->t == NULL means the matrix is empty
+		k2->lw = NULL;
+	}
 
 	return k2;
 }
@@ -66,136 +157,227 @@ K2Reader* k2_init(Reader* r) {
 void k2_destroy(K2Reader* k) {
 	if(k->t)
 		bitsequence_reader_destroy(k->t);
+	free(k->lw);
 	free(k);
 }
 
+// returns the leaf^2 bits of the leaf i of L, the cell (p, q) of the leaf at bit p * leaf + q
+static inline uint64_t leaf_get(K2Reader* k, uint64_t i) {
+	int bits = k->leaf * k->leaf;
+	uint64_t x = i * bits;
+
+	if(k->lw) {
+		int o = x % 64;
+		uint64_t v = k->lw[x / 64] >> o;
+		if(o + bits > 64) // the leaf continues in the next word, if its size is no divisor of 64
+			v |= k->lw[x / 64 + 1] << (64 - o);
+
+		return bits == 64 ? v : v & ((1ULL << bits) - 1);
+	}
+
+	Reader l = k->l;
+	reader_bitpos(&l, x);
+	return word_reverse(reader_readint(&l, bits) << (64 - bits));
+}
+
+// returns the index of the leaf x of the last level of T
+#define leaf_index(k, x) ((k)->base[(k)->levels] + bitsequence_reader_rank1((k)->t, x))
+
+// returns the bits of the row p of a leaf
+static inline uint64_t leaf_row(K2Reader* k, uint64_t leaf, uint64_t p) {
+	return (leaf >> (p * k->leaf)) & ((1ULL << k->leaf) - 1);
+}
+
+// returns the bits of the column q of a leaf
+static inline uint64_t leaf_column(K2Reader* k, uint64_t leaf, uint64_t q) {
+	uint64_t bits = 0;
+	for(int i = 0; i < k->leaf; i++)
+		bits |= ((leaf >> (i * k->leaf + q)) & 1) << i;
+	return bits;
+}
+
 bool k2_get(K2Reader* k, uint64_t r, uint64_t c) {
 	if(r >= k->height || c >= k->width)
 		return false;
 	if(!k->t)
 		return false;
 
-	uint64_t n = k->n / k->k;
-	uint64_t p = r % n;
-	uint64_t q = c % n;
-	uint64_t x = k->k * (r / n) + c / n;
+	uint64_t n = k->n;
+	int64_t x = -1; // root
+
+	for(int d = 0; d < k->levels; d++) {
+		uint64_t s = k->split[d];
+		n /= s;
 
-	while(x < bitsequence_reader_len(k->t)) {
+		x = k->base[d] + bitsequence_reader_rank1(k->t, x) * (s * s) + s * (r / n) + c / n;
 		if(!bitsequence_reader_access(k->t, x))
 			return false;
 
-		n /= k->k;
-
-		x = bitsequence_reader_rank1(k->t, x) * (k->k * k->k) + k->k * (p / n) + q / n;
-
-		p %= n;
-		q %= n;
+		r %= n;
+		c %= n;
 	}
 
-	reader_bitpos(&k->l, x - bitsequence_reader_len(k->t));
-	return reader_readbit(&k->l);
+	return (leaf_get(k, leaf_index(k, x)) >> (r * k->leaf + c)) & 1;
 }
 
+// Node of the tree, whose children are visited by the column extraction.
 typedef struct {
-	size_t len;
-	size_t cap;
-	uint64_t* data;
-} IntList;
-
-// low level uint64_t list with capacity
-// used for the direct and reverse operations
-int int_append(IntList* l, uint64_t i) {
-	size_t cap = l->cap;
-
-	if(cap == l->len) {
-		cap = !cap ? 16 : (cap + (cap >> 1)); // default cap is 16 because the default rank is limited to 12
-		uint64_t* data = realloc(l->data, cap * sizeof(*data));
-		if(!data)
-			return -1;
-
-		l->cap = cap;
-		l->data = data;
+	uint64_t n; // size of the submatrices of the children
+	uint64_t p; // first row of the node
+	uint64_t q; // first column of the node
+	uint64_t y; // position of the first child in T
+	uint64_t j; // next row of children
+	size_t lo; // first column in the node
+	size_t hi; // end of the columns in the node
+	size_t g; // first column of the next child in the current row of children
+} K2ColumnNode;
+
+// Appends the rows of the columns qs[lo, hi) of the leaf i, which starts at (p, q).
+static void k2_columns_leaf(K2Reader* k, uint64_t i, uint64_t p, uint64_t q, const uint64_t* qs, size_t lo, size_t hi,
+		uint64_t* rows, size_t cap, size_t* lens) {
+	uint64_t leaf = leaf_get(k, i);
+
+	for(size_t c = lo; c < hi; c++) {
+		uint64_t bits = leaf_column(k, leaf, qs[c] - q);
+		while(bits) {
+			if(lens[c] < cap)
+				rows[c * cap + lens[c]] = p + __builtin_ctzll(bits);
+			lens[c]++;
+			bits &= bits - 1;
+		}
 	}
-
-	l->data[l->len++] = i;
-	return 0;
 }
 
-// x is signed because it can be -1
-static int k2reverse(K2Reader* k, uint64_t n, uint64_t q, uint64_t p, int64_t x, IntList* l) {
-	if(p >= k->height)
+size_t k2_columns(K2Reader* k, const uint64_t* qs, size_t n, uint64_t* rows, size_t cap, size_t* lens) {
+	size_t i;
+	for(i = 0; i < n; i++)
+		lens[i] = 0;
+
+	if(!k->t)
+		return 0;
+
+	size_t hi = 0; // the columns outside of the matrix are ignored
+	while(hi < n && qs[hi] < k->width)
+		hi++;
+	if(hi == 0)
 		return 0;
-	if(x >= (int64_t) bitsequence_reader_len(k->t)) { // Warning: comparing signed values
-		reader_bitpos(&k->l, x - bitsequence_reader_len(k->t));
-		if(reader_readbit(&k->l))
-			if(int_append(l, p) < 0)
-				return -1;
-	}
-	else {
-		if(x == -1 || bitsequence_reader_access(k->t, x)) {
-			uint64_t nnew = n / k->k;
-			uint64_t y = bitsequence_reader_rank1(k->t, x) * (k->k * k->k) + (q / nnew);
 
-			for(int j = 0; j < k->k; j++)
-				if(k2reverse(k, nnew, q % nnew, p + nnew * j, y + j * k->k, l) < 0)
-					return -1;
+	K2ColumnNode stack[K2_MAX_LEVELS];
+	int depth = 0;
+
+	if(k->levels > 0)
+		stack[depth++] = (K2ColumnNode) {.n = k->n / k->split[0], .p = 0, .q = 0, .y = 0, .j = 0, .lo = 0, .hi = hi, .g = 0};
+	else // the root is a leaf
+		k2_columns_leaf(k, leaf_index(k, -1), 0, 0, qs, 0, hi, rows, cap, lens);
+
+	while(depth > 0) {
+		K2ColumnNode* node = &stack[depth - 1];
+		uint64_t s = k->split[depth - 1];
+
+		uint64_t j = node->j;
+		uint64_t p = node->p + node->n * j;
+		if(j >= s || p >= k->height) {
+			depth--;
+			continue;
+		}
+
+		// the columns of the same child are visited together
+		size_t g = node->g;
+		uint64_t c = (qs[g] - node->q) / node->n;
+		size_t g_end = g + 1;
+		while(g_end < node->hi && (qs[g_end] - node->q) / node->n == c)
+			g_end++;
+
+		if(g_end < node->hi)
+			node->g = g_end;
+		else { // continue with the next row of children
+			node->g = node->lo;
+			node->j++;
+		}
+
+		uint64_t x = node->y + j * s + c;
+		if(!bitsequence_reader_access(k->t, x))
+			continue;
+
+		uint64_t q = node->q + c * node->n;
+		if(depth == k->levels)
+			k2_columns_leaf(k, leaf_index(k, x), p, q, qs, g, g_end, rows, cap, lens);
+		else {
+			uint64_t sc = k->split[depth];
+			stack[depth] = (K2ColumnNode) {
+				.n = node->n / sc,
+				.p = p,
+				.q = q,
+				.y = k->base[depth] + bitsequence_reader_rank1(k->t, x) * (sc * sc),
+				.j = 0,
+				.lo = g,
+				.hi = g_end,
+				.g = g,
+			};
+			depth++;
 		}
 	}
-	return 0;
+
+	size_t total = 0;
+	for(i = 0; i < n; i++)
+		total += lens[i] = MIN(lens[i], cap);
+
+	return total;
 }
 
-uint64_t* k2_column(K2Reader* k, uint64_t q, size_t* l) {
-	if(q < 0 || q >= k->width) {
-		*l = 0;
-		return NULL;
-	}
-	if(!k->t) {
-		*l = 0;
-		return NULL;
+size_t k2_column(K2Reader* k, uint64_t q, uint64_t* rows, size_t cap) {
+	size_t len;
+	k2_columns(k, &q, 1, rows, cap, &len);
+	return len;
+}
+
+// Visits the node x of T (-1 for the root) at the depth of the stack of the iterator. The node covers a submatrix
+// of size n, p and q are the row and column relative to the submatrix for the iterated row and column respectively.
+// The inner nodes are pushed onto the stack, the row or column of a leaf is kept by the iterator.
+static void k2_iter_visit(K2Iterator* it, uint64_t n, uint64_t p, uint64_t q, int64_t x) {
+	K2Reader* k = it->k;
+
+	if(it->depth == k->levels) {
+		uint64_t leaf = leaf_get(k, leaf_index(k, x));
+		it->leaf = it->row ? leaf_row(k, leaf, p) : leaf_column(k, leaf, q);
+		it->leaf_v = it->row ? q : p;
+		return;
 	}
 
-	IntList li = {0}; // initializing with zeros
-	if(k2reverse(k, k->n, q, 0, -1, &li) < 0)
-		return NULL;
+	uint64_t s = k->split[it->depth];
+	K2IteratorNode* node = &it->stack[it->depth++];
 
-	*l = li.len; // our list li has a capacity but we ignore it. just using len :)
-	return li.data;
-}
+	node->n = n / s;
+	node->y = k->base[it->depth - 1] + bitsequence_reader_rank1(k->t, x) * (s * s);
+	node->j = 0;
 
-typedef struct {
-	uint64_t n;
-	uint64_t p;
-	uint64_t q;
-	int64_t x;
-} K2IteratorElement;
+	if(it->row) {
+		node->y += s * (p / node->n);
+		node->p = p % node->n;
+		node->q = q;
+	}
+	else {
+		node->y += q / node->n;
+		node->p = p;
+		node->q = q % node->n;
+	}
+}
 
 static void k2_iter_init(K2Reader* k, uint64_t v, bool row, K2Iterator* it) {
 	it->k = k;
 	it->row = row;
-	it->has_next = false; // set it to true if the element could be added to the queue
+	it->depth = 0;
+	it->leaf = 0;
+	it->has_next = false;
 
 	if(k->t) {
-		ringqueue_init(&it->queue, MIN(k->height, 16));
-
-		K2IteratorElement* l = malloc(sizeof(*l));
-		if(!l)
-			return;
-
-		l->n = k->n;
-		l->x = -1;
-
-		if(row) {
-			l->p = v;
-			l->q = 0;
-		}
-		else {
-			l->p = 0;
-			l->q = v;
+		if(v < (row ? k->height : k->width)) {
+			if(row)
+				k2_iter_visit(it, k->n, v, 0, -1);
+			else
+				k2_iter_visit(it, k->n, 0, v, -1);
 		}
 
-		if(ringqueue_enqueue(&it->queue, l) < 0)
-			return;
-
 		it->has_next = true;
 	}
 }
@@ -205,90 +387,320 @@ void k2_iter_init_row(K2Reader* k, uint64_t p, K2Iterator* it) {
 }
 
 static int k2_iter_next_element(K2Iterator* it, uint64_t* v) {
-	int res = 0;
-	while(!ringqueue_empty(&it->queue) && res != 1) {
-		K2IteratorElement* l = ringqueue_dequeue(&it->queue);
+	K2Reader* k2 = it->k;
 
-		// check if width / height reached
-		if(it->row) {
-			if(l->q >= it->k->width)
-				goto loop_continue;
+	for(;;) {
+		if(it->leaf) {
+			*v = it->leaf_v + __builtin_ctzll(it->leaf);
+			it->leaf &= it->leaf - 1;
+			return 1;
 		}
-		else {
-			if(l->p >= it->k->height)
-				goto loop_continue;
+
+		if(it->depth == 0)
+			return 0;
+
+		K2IteratorNode* node = &it->stack[it->depth - 1];
+		uint64_t k = k2->split[it->depth - 1];
+		if(node->j >= k) {
+			it->depth--;
+			continue;
 		}
 
-		if(l->x >= (int64_t) bitsequence_reader_len(it->k->t)) { // Warning: comparing signed values
-			reader_bitpos(&it->k->l, l->x - bitsequence_reader_len(it->k->t));
-			if(reader_readbit(&it->k->l)) {
-				*v = it->row ? l->q : l->p;
-				res = 1;
-				goto loop_continue;
+		uint64_t j = node->j++;
+		uint64_t p, q, x;
+		if(it->row) {
+			p = node->p;
+			q = node->q + node->n * j;
+			x = node->y + j;
+
+			if(q >= k2->width) { // the remaining children are outside of the matrix too
+				node->j = k;
+				continue;
 			}
 		}
 		else {
-			if(l->x == -1 || bitsequence_reader_access(it->k->t, l->x)) {
-				uint64_t k = it->k->k;
-				uint64_t nnew = l->n / k;
-
-				uint64_t y = bitsequence_reader_rank1(it->k->t, l->x) * (k * k);
-				if(it->row)
-					y += k * (l->p / nnew);
-				else
-					y += l->q / nnew;
-
-				for(int j = 0; j < k; j++) {
-					K2IteratorElement* el = malloc(sizeof(*el));
-					if(!el) {
-						res = -1;
-						goto loop_continue;
-					}
-
-					el->n = nnew;
-					if(it->row) {
-						el->p = l->p % nnew;
-						el->q = l->q + nnew * j;
-						el->x = y + j;
-					}
-					else {
-						el->p = l->p + nnew * j;
-						el->q = l->q % nnew;
-						el->x = y + j * k;
-					}
-
-					if(ringqueue_enqueue(&it->queue, el) < 0) {
-						// TODO: goto und free
-					}
-				}
+			p = node->p + node->n * j;
+			q = node->q;
+			x = node->y + j * k;
+
+			if(p >= k2->height) {
+				node->j = k;
+				continue;
 			}
 		}
 
-loop_continue:
-		free(l);
+		if(bitsequence_reader_access(k2->t, x))
+			k2_iter_visit(it, node->n, p, q, x);
 	}
-
-	return res;
 }
 
 int k2_iter_next(K2Iterator* it, uint64_t* v) {
 	if(!it->has_next)
 		return -1;
 
-	uint64_t n;
-	int res = k2_iter_next_element(it, &n);
+	int res = k2_iter_next_element(it, v);
 	if(res != 1)
 		k2_iter_finish(it);
 
-	*v = n;
 	return res;
 }
 
 void k2_iter_finish(K2Iterator* it) {
+	it->has_next = false;
+}
+
+// returns the bits of the cells of a leaf of size l at (p, q), which are inside the region
+static uint64_t region_mask(const K2RegionIterator* it, int l, uint64_t p, uint64_t q) {
+	uint64_t row = 0;
+	for(int c = 0; c < l; c++)
+		if(q + c >= it->q1 && q + c < it->q2)
+			row |= 1ULL << c;
+
+	uint64_t mask = 0;
+	for(int r = 0; r < l; r++)
+		if(p + r >= it->p1 && p + r < it->p2)
+			mask |= row << (r * l);
+
+	return mask;
+}
+
+// Visits the node x of T (-1 for the root) of size n at (p, q), like k2_iter_visit.
+static void k2_region_visit(K2RegionIterator* it, uint64_t n, uint64_t p, uint64_t q, int64_t x) {
+	K2Reader* k = it->k;
+
+	if(it->depth == k->levels) {
+		it->leaf = leaf_get(k, leaf_index(k, x)) & region_mask(it, k->leaf, p, q);
+		it->leaf_p = p;
+		it->leaf_q = q;
+		return;
+	}
+
+	uint64_t s = k->split[it->depth];
+	K2RegionNode* node = &it->stack[it->depth++];
+
+	node->n = n / s;
+	node->p = p;
+	node->q = q;
+	node->y = k->base[it->depth - 1] + bitsequence_reader_rank1(k->t, x) * (s * s);
+	node->j = 0;
+}
+
+void k2_region_init(K2Reader* k, uint64_t p1, uint64_t p2, uint64_t q1, uint64_t q2, K2RegionIterator* it) {
+	it->k = k;
+	it->p1 = p1;
+	it->p2 = MIN(p2, k->height);
+	it->q1 = q1;
+	it->q2 = MIN(q2, k->width);
+	it->depth = 0;
+	it->leaf = 0;
+	it->has_next = false;
+
+	if(k->t) {
+		if(it->p1 < it->p2 && it->q1 < it->q2)
+			k2_region_visit(it, k->n, 0, 0, -1);
+
+		it->has_next = true;
+	}
+}
+
+static int k2_region_next_element(K2RegionIterator* it, uint64_t* p, uint64_t* q) {
+	K2Reader* k2 = it->k;
+
+	for(;;) {
+		if(it->leaf) {
+			int i = __builtin_ctzll(it->leaf);
+			it->leaf &= it->leaf - 1;
+
+			*p = it->leaf_p + i / k2->leaf;
+			*q = it->leaf_q + i % k2->leaf;
+			return 1;
+		}
+
+		if(it->depth == 0)
+			return 0;
+
+		K2RegionNode* node = &it->stack[it->depth - 1];
+		uint64_t k = k2->split[it->depth - 1];
+		if(node->j >= k * k) {
+			it->depth--;
+			continue;
+		}
+
+		uint64_t jr = node->j / k;
+		uint64_t jc = node->j % k;
+		uint64_t cp = node->p + node->n * jr;
+		uint64_t cq = node->q + node->n * jc;
+
+		if(cp >= it->p2) { // the remaining children are below the region
+			node->j = k * k;
+			continue;
+		}
+		if(cp + node->n <= it->p1) { // the row of children is above the region
+			node->j = (jr + 1) * k;
+			continue;
+		}
+		if(cq >= it->q2) { // the remaining children of the row are right of the region
+			node->j = (jr + 1) * k;
+			continue;
+		}
+
+		uint64_t j = node->j++;
+		if(cq + node->n <= it->q1)
+			continue;
+
+		uint64_t x = node->y + j;
+		if(bitsequence_reader_access(k2->t, x))
+			k2_region_visit(it, node->n, cp, cq, x);
+	}
+}
+
+int k2_region_next(K2RegionIterator* it, uint64_t* p, uint64_t* q) {
+	if(!it->has_next)
+		return -1;
+
+	int res = k2_region_next_element(it, p, q);
+	if(res != 1)
+		k2_region_finish(it);
+
+	return res;
+}
+
+void k2_region_finish(K2RegionIterator* it) {
+	it->has_next = false;
+}
+
+// Visits the nodes xs of T (-1 for the root) of the rows, which are of size n at the column q, like k2_iter_visit.
+static void k2_rows_visit(K2RowsIterator* it, uint64_t n, uint64_t q, const int64_t* xs) {
+	K2Reader* k = it->k;
+	int i;
+
+	if(it->depth == k->levels) {
+		uint64_t bits = ~0ULL;
+		for(i = 0; i < it->m && bits; i++)
+			bits &= leaf_row(k, leaf_get(k, leaf_index(k, xs[i])), it->rows[i] % n);
+
+		it->leaf = bits;
+		it->leaf_q = q;
+		return;
+	}
+
+	uint64_t s = k->split[it->depth];
+	uint64_t* y = it->y + it->depth * it->m;
+	K2RowsNode* node = &it->stack[it->depth++];
+
+	node->n = n / s;
+	node->q = q;
+	node->j = 0;
+
+	for(i = 0; i < it->m; i++) {
+		// the rows in the same subtree share their nodes
+		if(i > 0 && xs[i] == xs[i - 1] && it->rows[i] % n / node->n == it->rows[i - 1] % n / node->n)
+			y[i] = y[i - 1];
+		else
+			y[i] = k->base[it->depth - 1] + bitsequence_reader_rank1(k->t, xs[i]) * (s * s) + s * (it->rows[i] % n / node->n);
+	}
+}
+
+int k2_rows_init(K2Reader* k, const uint64_t* rows, int m, K2RowsIterator* it) {
+	it->k = k;
+	it->depth = 0;
+	it->leaf = 0;
+	it->has_next = false;
+	it->m = 0;
+
+	int levels = k->levels > 0 ? k->levels : 1;
+	it->rows = malloc((m + (size_t) levels * m + m + 1) * sizeof(uint64_t));
+	if(!it->rows)
+		return -1;
+
+	it->y = it->rows + m;
+	int64_t* xs = (int64_t*) (it->y + (size_t) levels * m);
+
+	// the rows are sorted and duplicates are removed
+	bool empty = m == 0;
+	for(int i = 0; i < m; i++) {
+		uint64_t r = rows[i];
+		if(r >= k->height)
+			empty = true;
+
+		int j = it->m;
+		while(j > 0 && it->rows[j - 1] > r)
+			j--;
+		if(j > 0 && it->rows[j - 1] == r)
+			continue;
+
+		memmove(it->rows + j + 1, it->rows + j, (it->m - j) * sizeof(uint64_t));
+		it->rows[j] = r;
+		it->m++;
+	}
+
+	it->has_next = true;
+
+	if(k->t && !empty) {
+		for(int i = 0; i < it->m; i++)
+			xs[i] = -1;
+		k2_rows_visit(it, k->n, 0, xs);
+	}
+
+	return 0;
+}
+
+static int k2_rows_next_element(K2RowsIterator* it, uint64_t* v) {
+	K2Reader* k2 = it->k;
+	int64_t* xs = (int64_t*) (it->y + (size_t) MAX(k2->levels, 1) * it->m);
+
+	for(;;) {
+		if(it->leaf) {
+			*v = it->leaf_q + __builtin_ctzll(it->leaf);
+			it->leaf &= it->leaf - 1;
+			return 1;
+		}
+
+		if(it->depth == 0)
+			return 0;
+
+		K2RowsNode* node = &it->stack[it->depth - 1];
+		uint64_t k = k2->split[it->depth - 1];
+		if(node->j >= k) {
+			it->depth--;
+			continue;
+		}
+
+		uint64_t j = node->j++;
+		uint64_t q = node->q + node->n * j;
+		if(q >= k2->width) { // the remaining children are outside of the matrix too
+			node->j = k;
+			continue;
+		}
+
+		// the child has to exist in all rows
+		const uint64_t* y = it->y + (it->depth - 1) * it->m;
+		bool all = true;
+		for(int i = 0; i < it->m && all; i++) {
+			xs[i] = y[i] + j;
+			if(i == 0 || y[i] != y[i - 1])
+				all = bitsequence_reader_access(k2->t, xs[i]);
+		}
+
+		if(all)
+			k2_rows_visit(it, node->n, q, xs);
+	}
+}
+
+int k2_rows_next(K2RowsIterator* it, uint64_t* v) {
+	if(!it->has_next)
+		return -1;
+
+	int res = k2_rows_next_element(it, v);
+	if(res != 1)
+		k2_rows_finish(it);
+
+	return res;
+}
+
+void k2_rows_finish(K2RowsIterator* it) {
 	if(it->has_next) {
-		while(!ringqueue_empty(&it->queue))
-			free(ringqueue_dequeue(&it->queue));
-		ringqueue_destroy(&it->queue);
+		free(it->rows);
 		it->has_next = false;
 	}
 }
@@ -7,16 +7,26 @@
 #define K2TREE_H
 
 #include <bitsequence_r.h>
-#include <ringqueue.h>
+
+// The height of a k2-tree is at most 64, because k is at least 2.
+#define K2_MAX_LEVELS 64
 
 typedef struct {
 	uint64_t width;
 	uint64_t height;
-	int k; // just using normal int because normally our k is 2
 	uint64_t n;
 
+	// The arity k of a level can differ, so a hybrid tree can use a larger k at the upper levels.
+	// The children of a node at depth d, which is the bit x of T (-1 for the root), are the bits
+	// base[d] + rank1(x) * split[d]^2 of the level d of T. The nodes at the depth `levels` are the leaves.
+	int levels;
+	uint8_t split[K2_MAX_LEVELS];
+	uint64_t base[K2_MAX_LEVELS + 1];
+	int leaf; // size of the submatrices of the leaves, stored with leaf^2 bits in L
+
 	BitsequenceReader* t; // bitsequence T with a bitsequence reader
 	Reader l; // bitsequence L is not optimized for rank / select because only access is needed.
+	uint64_t* lw; // bitsequence L decoded into words, if the file reader is opened in memory
 } K2Reader;
 
 K2Reader* k2_init(Reader* r);
@@ -24,15 +34,36 @@ void k2_destroy(K2Reader* k);
 
 bool k2_get(K2Reader* k, uint64_t r, uint64_t c);
 
-// The column can be determined via a regular function because the number of elements in the pointer
-// are limited to the rank of the compression.
-uint64_t* k2_column(K2Reader* k, uint64_t q, size_t* l);
+// The column can be determined via a regular function because the number of elements
+// is limited to the rank of the compression.
+// Writes the rows of the column q in ascending order to `rows`, but at most `cap` rows, and returns their number.
+size_t k2_column(K2Reader* k, uint64_t q, uint64_t* rows, size_t cap);
+
+// Extracts the n columns `qs`, which have to be sorted in ascending order, in a single traversal of the tree,
+// so the upper levels are only visited once for adjacent columns.
+// The rows of the column qs[i] are written to rows[i * cap], their number to lens[i].
+// Returns the number of all rows.
+size_t k2_columns(K2Reader* k, const uint64_t* qs, size_t n, uint64_t* rows, size_t cap, size_t* lens);
+
+// Node of the tree, whose children are visited by the iterator.
+typedef struct {
+	uint64_t n; // size of the submatrices of the children
+	uint64_t p; // row of the children
+	uint64_t q; // column of the children
+	uint64_t y; // position of the first child in T
+	uint64_t j; // next child
+} K2IteratorNode;
 
+// The tree is traversed depth first with a stack of the visited nodes, one for each level.
+// Thus the elements are returned in ascending order without allocations.
 typedef struct {
 	K2Reader* k;
 	bool row;
 	bool has_next;
-	RingQueue queue;
+	uint64_t leaf; // remaining bits of the row or column of the current leaf
+	uint64_t leaf_v; // first row or column of the current leaf
+	int depth; // number of nodes on the stack
+	K2IteratorNode stack[K2_MAX_LEVELS];
 } K2Iterator;
 
 void k2_iter_init_row(K2Reader* k, uint64_t p, K2Iterator* it);
@@ -44,4 +75,68 @@ void k2_iter_init_row(K2Reader* k, uint64_t p, K2Iterator* it);
 int k2_iter_next(K2Iterator* it, uint64_t* v);
 void k2_iter_finish(K2Iterator* it); // needed if the K2Iterator was not iterated to the end
 
+// Node of the tree, whose children are visited by the region iterator.
+typedef struct {
+	uint64_t n; // size of the submatrices of the children
+	uint64_t p; // first row of the node
+	uint64_t q; // first column of the node
+	uint64_t y; // position of the first child in T
+	uint64_t j; // next child
+} K2RegionNode;
+
+// Iterates the cells of the rows [p1, p2) and the columns [q1, q2) with a one.
+// The cells are returned in the order of the tree, the subtrees outside of the region are skipped.
+typedef struct {
+	K2Reader* k;
+	uint64_t p1, p2;
+	uint64_t q1, q2;
+	bool has_next;
+	uint64_t leaf; // remaining cells of the current leaf
+	uint64_t leaf_p; // first row of the current leaf
+	uint64_t leaf_q; // first column of the current leaf
+	int depth;
+	K2RegionNode stack[K2_MAX_LEVELS];
+} K2RegionIterator;
+
+void k2_region_init(K2Reader* k, uint64_t p1, uint64_t p2, uint64_t q1, uint64_t q2, K2RegionIterator* it);
+
+// return value:
+// 1: next element exists
+// 0: no next element exists
+// -1: error occured
+int k2_region_next(K2RegionIterator* it, uint64_t* p, uint64_t* q);
+void k2_region_finish(K2RegionIterator* it);
+
+// Node of the tree, whose children are visited by the multi-row iterator.
+// The positions of the children of each row are stored by the iterator.
+typedef struct {
+	uint64_t n; // size of the submatrices of the children
+	uint64_t q; // first column of the node
+	uint64_t j; // next child
+} K2RowsNode;
+
+// Iterates the columns with a one in all of the given rows in ascending order.
+// The rows are traversed together, so a subtree is skipped as soon as one of the rows is empty in it.
+typedef struct {
+	K2Reader* k;
+	int m; // number of distinct rows
+	uint64_t* rows; // sorted rows
+	uint64_t* y; // position of the first child of each row for each node on the stack
+	bool has_next;
+	uint64_t leaf; // remaining columns of the current leaf
+	uint64_t leaf_q; // first column of the current leaf
+	int depth;
+	K2RowsNode stack[K2_MAX_LEVELS];
+} K2RowsIterator;
+
+// Returns -1 if the memory for the rows could not be allocated.
+int k2_rows_init(K2Reader* k, const uint64_t* rows, int m, K2RowsIterator* it);
+
+// return value:
+// 1: next element exists
+// 0: no next element exists
+// -1: error occured
+int k2_rows_next(K2RowsIterator* it, uint64_t* v);
+void k2_rows_finish(K2RowsIterator* it); // needed if the K2RowsIterator was not iterated to the end
+
 #endif
@@ -0,0 +1,194 @@
+/**
+ * @file ntcache.c
+ * @author FR
+ */
+
+#include "ntcache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <constants.h>
+#include <arith.h>
+
+#define entry_sizeof(len) (sizeof(NTCacheEntry) + (len) * sizeof(uint64_t))
+
+static inline uint64_t hash_nt(uint64_t nt) {
+	return nt * 0x9E3779B97F4A7C15L;
+}
+
+NTCache* ntcache_init(size_t size) {
+	NTCache* c = malloc(sizeof(*c));
+	if(!c)
+		return NULL;
+
+	// a bucket for every entry of the average size
+	size_t buckets = 1;
+	while(buckets < size / NT_CACHE_AVG_ENTRY)
+		buckets <<= 1;
+
+	c->buckets = calloc(buckets, sizeof(*c->buckets));
+	if(!c->buckets || pthread_mutex_init(&c->lock, NULL) != 0) {
+		free(c->buckets);
+		free(c);
+		return NULL;
+	}
+
+	c->capacity = size;
+	c->size = 0;
+	c->max_len = MIN(NT_CACHE_MAX_LEN, size / 8 / sizeof(uint64_t));
+	c->bucket_mask = buckets - 1;
+	c->list_head = NULL;
+	c->list_tail = NULL;
+	c->hits = 0;
+	c->misses = 0;
+
+	return c;
+}
+
+void ntcache_destroy(NTCache* c) {
+	NTCacheEntry* e = c->list_head;
+	while(e) {
+		NTCacheEntry* next = e->list_next;
+		free(e);
+		e = next;
+	}
+
+	pthread_mutex_destroy(&c->lock);
+	free(c->buckets);
+	free(c);
+}
+
+static inline NTCacheEntry** cache_bucket(NTCache* c, uint64_t nt) {
+	return &c->buckets[(hash_nt(nt) >> 32) & c->bucket_mask];
+}
+
+static void list_remove(NTCache* c, NTCacheEntry* e) {
+	if(!e->list_prev)
+		c->list_head = e->list_next;
+	else
+		e->list_prev->list_next = e->list_next;
+
+	if(!e->list_next)
+		c->list_tail = e->list_prev;
+	else
+		e->list_next->list_prev = e->list_prev;
+}
+
+static void list_push_front(NTCache* c, NTCacheEntry* e) {
+	NTCacheEntry* h = c->list_head;
+
+	e->list_prev = NULL;
+	e->list_next = h;
+
+	c->list_head = e;
+	if(!h)
+		c->list_tail = e;
+	else
+		h->list_prev = e;
+}
+
+// Removes the least recently used entry.
+static void cache_evict(NTCache* c) {
+	NTCacheEntry* e = c->list_tail;
+	list_remove(c, e);
+
+	NTCacheEntry** p = cache_bucket(c, e->nt);
+	while(*p != e)
+		p = &(*p)->hash_next;
+	*p = e->hash_next;
+
+	c->size -= entry_sizeof(e->len);
+	free(e);
+}
+
+// Looks up the NT, the hits and misses are only counted with `count`.
+static int64_t cache_get(NTCache* c, uint64_t nt, uint64_t* dst, size_t cap, bool count) {
+	pthread_mutex_lock(&c->lock);
+
+	NTCacheEntry* e = *cache_bucket(c, nt);
+	while(e && e->nt != nt)
+		e = e->hash_next;
+
+	// NTs marked as too large are expanded without the cache, so they count as misses
+	if(count) {
+		if(e && !e->too_large)
+			c->hits++;
+		else
+			c->misses++;
+	}
+
+	int64_t res = -1;
+	if(e) {
+		// move existing entry to front
+		if(c->list_head != e) {
+			list_remove(c, e);
+			list_push_front(c, e);
+		}
+
+		if(e->too_large)
+			res = -2;
+		else {
+			res = e->len;
+			if(e->len <= cap)
+				memcpy(dst, e->data, e->len * sizeof(uint64_t));
+		}
+	}
+
+	pthread_mutex_unlock(&c->lock);
+	return res;
+}
+
+int64_t ntcache_get(NTCache* c, uint64_t nt, uint64_t* dst, size_t cap) {
+	return cache_get(c, nt, dst, cap, true);
+}
+
+int64_t ntcache_copy(NTCache* c, uint64_t nt, uint64_t* dst, size_t cap) {
+	return cache_get(c, nt, dst, cap, false);
+}
+
+int ntcache_put(NTCache* c, uint64_t nt, const uint64_t* data, size_t len) {
+	if(!data)
+		len = 0;
+
+	NTCacheEntry* e = malloc(entry_sizeof(len));
+	if(!e)
+		return -1;
+
+	e->nt = nt;
+	e->too_large = !data;
+	e->len = len;
+	if(data)
+		memcpy(e->data, data, len * sizeof(uint64_t));
+
+	pthread_mutex_lock(&c->lock);
+
+	// the NT may be added by another thread in the meantime
+	NTCacheEntry** bucket = cache_bucket(c, nt);
+	for(NTCacheEntry* f = *bucket; f; f = f->hash_next) {
+		if(f->nt == nt) {
+			pthread_mutex_unlock(&c->lock);
+			free(e);
+			return 0;
+		}
+	}
+
+	while(c->list_tail && c->size + entry_sizeof(len) > c->capacity)
+		cache_evict(c);
+
+	e->hash_next = *bucket;
+	*bucket = e;
+	list_push_front(c, e);
+	c->size += entry_sizeof(len);
+
+	pthread_mutex_unlock(&c->lock);
+	return 0;
+}
+
+void ntcache_stats(NTCache* c, uint64_t* hits, uint64_t* misses) {
+	pthread_mutex_lock(&c->lock);
+	if(hits)
+		*hits = c->hits;
+	if(misses)
+		*misses = c->misses;
+	pthread_mutex_unlock(&c->lock);
+}
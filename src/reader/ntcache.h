@@ -0,0 +1,65 @@
+/**
+ * @file ntcache.h
+ * @author FR
+ */
+
+#ifndef NTCACHE_H
+#define NTCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// The expansion of a NT are its terminal edges, whose nodes are the indices of the nodes of the NT.
+// Each edge is stored as its nodes followed by its label and rank, the edges are stored from the last to the first one.
+// So the expansion can be copied to the stack of the decompression and the first edge is on the top.
+typedef struct NTCacheEntry_ {
+	uint64_t nt;
+	struct NTCacheEntry_* hash_next;
+	struct NTCacheEntry_* list_prev;
+	struct NTCacheEntry_* list_next;
+
+	bool too_large; // the expansion exceeds the maximum length, so the NT is decompressed as usual
+	size_t len; // number of words of the expansion
+	uint64_t data[];
+} NTCacheEntry;
+
+// LRU cache of the expansions of the NTs with a lock.
+typedef struct {
+	pthread_mutex_t lock;
+
+	size_t capacity; // maximum number of bytes
+	size_t size;
+	size_t max_len; // maximum number of words of an expansion
+
+	NTCacheEntry** buckets; // heads of the hash chains
+	size_t bucket_mask;
+
+	// linked list to store the last used entries
+	NTCacheEntry* list_head;
+	NTCacheEntry* list_tail;
+
+	uint64_t hits;
+	uint64_t misses;
+} NTCache;
+
+// `size` is the memory budget in bytes.
+NTCache* ntcache_init(size_t size);
+void ntcache_destroy(NTCache* c);
+
+// return value:
+// >= 0: length of the expansion, it is copied to `dst`, if it does not exceed `cap` words
+// -1: the NT is not cached
+// -2: the expansion of the NT is too large to be cached
+int64_t ntcache_get(NTCache* c, uint64_t nt, uint64_t* dst, size_t cap);
+// Like `ntcache_get`, but the lookup is not counted in the statistics.
+// Used to copy the expansion again, after `dst` was enlarged.
+int64_t ntcache_copy(NTCache* c, uint64_t nt, uint64_t* dst, size_t cap);
+
+// Adds the expansion of a NT, if `data` is NULL, the NT is marked as too large.
+int ntcache_put(NTCache* c, uint64_t nt, const uint64_t* data, size_t len);
+
+void ntcache_stats(NTCache* c, uint64_t* hits, uint64_t* misses);
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file ntcounts.c
+ * @author FR
+ */
+
+#include "ntcounts.h"
+
+#include <stdlib.h>
+
+NTCountsReader* ntcounts_init(Reader* r) {
+	size_t nbytes;
+	int max_rank = reader_vbyte(r, &nbytes);
+	FileOff off = nbytes;
+
+	int bits_key = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	int bits_count = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	FileOff len_table = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	if(max_rank < 1 || bits_key < 1 || bits_key > 64 || bits_count < 1 || bits_count > 64)
+		return NULL;
+
+	Reader rt;
+	reader_init(r, &rt, off);
+	EliasFanoReader* table = eliasfano_init(&rt);
+	if(!table)
+		return NULL;
+
+	NTCountsReader* c = malloc(sizeof(*c));
+	if(!c) {
+		eliasfano_destroy(table);
+		return NULL;
+	}
+
+	c->table = table;
+	c->max_rank = max_rank;
+	c->bits_key = bits_key;
+	c->bits_count = bits_count;
+	reader_init(r, &c->r, off + len_table);
+
+	return c;
+}
+
+void ntcounts_destroy(NTCountsReader* c) {
+	eliasfano_destroy(c->table);
+	free(c);
+}
+
+static inline uint64_t entry_key(NTCountsReader* c, uint64_t i) {
+	Reader r = c->r;
+	reader_bitpos(&r, i * (c->bits_key + c->bits_count));
+	return reader_readint(&r, c->bits_key);
+}
+
+uint64_t ntcounts_get(NTCountsReader* c, uint64_t nt, CGraphEdgeLabel label, CGraphRank rank) {
+	if(nt + 1 >= c->table->n || (rank != CGRAPH_NODES_ALL && (rank < 0 || rank > c->max_rank)))
+		return 0;
+
+	EliasFanoCursor cur;
+	uint64_t start, end;
+	eliasfano_cursor(c->table, nt, &cur);
+	if(!eliasfano_cursor_next(&cur, &start) || !eliasfano_cursor_next(&cur, &end))
+		return 0;
+
+	uint64_t keys = c->max_rank + 1;
+
+	// with a bound label, the first entry of the label is searched
+	if(label != CGRAPH_LABELS_ALL) {
+		uint64_t first = label * keys, hi = end;
+		while(start < hi) {
+			uint64_t mid = (start + hi) / 2;
+			if(entry_key(c, mid) < first)
+				start = mid + 1;
+			else
+				hi = mid;
+		}
+	}
+
+	uint64_t count = 0;
+	if(start >= end)
+		return 0;
+
+	Reader r = c->r;
+	reader_bitpos(&r, start * (c->bits_key + c->bits_count));
+	for(uint64_t i = start; i < end; i++) {
+		uint64_t key = reader_readint(&r, c->bits_key);
+		uint64_t n = reader_readint(&r, c->bits_count);
+
+		if(label != CGRAPH_LABELS_ALL && key / keys != (uint64_t) label)
+			break;
+		if(rank == CGRAPH_NODES_ALL || key % keys == (uint64_t) rank)
+			count += n;
+	}
+
+	return count;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file ntcounts.h
+ * @author FR
+ */
+
+#ifndef NTCOUNTS_H
+#define NTCOUNTS_H
+
+#include <reader.h>
+#include <eliasfano.h>
+#include <cgraph.h>
+
+// Reader of the number of terminal edges produced by each NT, grouped by the label and the rank of the edges.
+// The entries of a NT are sorted by the key `label * (max_rank + 1) + rank`.
+typedef struct {
+	EliasFanoReader* table; // offsets of the entries of each NT
+	int max_rank;
+	int bits_key;
+	int bits_count;
+	Reader r; // reader at the start of the entries
+} NTCountsReader;
+
+NTCountsReader* ntcounts_init(Reader* r);
+void ntcounts_destroy(NTCountsReader* c);
+
+// Returns the number of terminal edges with the label `label` and the rank `rank` produced by the NT with the index `nt`.
+// The label and the rank may be unbound with `CGRAPH_LABELS_ALL` and `CGRAPH_NODES_ALL`.
+uint64_t ntcounts_get(NTCountsReader* c, uint64_t nt, CGraphEdgeLabel label, CGraphRank rank);
+
+#endif
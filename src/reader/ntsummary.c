@@ -0,0 +1,69 @@
+/**
+ * @file ntsummary.c
+ * @author FR
+ */
+
+#include "ntsummary.h"
+
+#include <stdlib.h>
+#include <constants.h>
+
+NTSummaryReader* ntsummary_init(Reader* r) {
+	size_t nbytes;
+	int max_rank = reader_vbyte(r, &nbytes);
+	if(max_rank < 1)
+		return NULL;
+
+	Reader rk;
+	reader_init(r, &rk, nbytes);
+
+	K2Reader* k = k2_init(&rk);
+	if(!k)
+		return NULL;
+
+	NTSummaryReader* s = malloc(sizeof(*s));
+	if(!s) {
+		k2_destroy(k);
+		return NULL;
+	}
+
+	s->k = k;
+	s->max_rank = max_rank;
+
+	return s;
+}
+
+void ntsummary_destroy(NTSummaryReader* s) {
+	k2_destroy(s->k);
+	free(s);
+}
+
+bool ntsummary_match(NTSummaryReader* s, uint64_t nt, const uint64_t* nodes, int len, CGraphRank rank, const CGraphNode* bound) {
+	if(rank < 1) // all ranks
+		return true;
+	if(rank > s->max_rank)
+		return false;
+
+	len = len < s->max_rank ? len : s->max_rank;
+	bool any = false;
+
+	for(int p = 0; p < rank; p++) {
+		if(bound[p] == CGRAPH_NODES_ALL)
+			continue;
+
+		// the bound node may be contained multiple times in the nodes of the NT
+		bool found = false;
+		for(int x = 0; x < len && !found; x++)
+			found = nodes[x] == (uint64_t) bound[p] && k2_get(s->k, nt, NT_SUMMARY_COLUMN(rank, p, x, s->max_rank));
+
+		if(!found)
+			return false;
+		any = true;
+	}
+
+	// without bound nodes, only the rank is checked with the nodes at the first position
+	for(int x = 0; x < len && !any; x++)
+		any = k2_get(s->k, nt, NT_SUMMARY_COLUMN(rank, 0, x, s->max_rank));
+
+	return any;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file ntsummary.h
+ * @author FR
+ */
+
+#ifndef NTSUMMARY_H
+#define NTSUMMARY_H
+
+#include <stdbool.h>
+#include <reader.h>
+#include <k2.h>
+#include <cgraph.h>
+
+// Reader of the summaries of the NTs, which extend the NT table.
+// For every NT, the summary contains the triples (rank, position, node) of the terminal edges produced by the NT.
+typedef struct {
+	K2Reader* k; // the NTs as rows and the triples as columns
+	int max_rank;
+} NTSummaryReader;
+
+NTSummaryReader* ntsummary_init(Reader* r);
+void ntsummary_destroy(NTSummaryReader* s);
+
+// Checks if the NT with the index `nt` and the nodes `nodes` may produce a terminal edge with the rank `rank`,
+// which contains the bound nodes of `bound` at their positions.
+bool ntsummary_match(NTSummaryReader* s, uint64_t nt, const uint64_t* nodes, int len, CGraphRank rank, const CGraphNode* bound);
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file pef.c
+ * @author FR
+ */
+
+#include "pef.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <constants.h>
+#include <arith.h>
+#include <panic.h>
+
+PEFReader* pef_init(Reader* r) {
+	size_t nbytes;
+	uint64_t n = reader_vbyte(r, &nbytes);
+	FileOff off = nbytes;
+
+	int bits_base = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	int bits_off = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	uint64_t data_len = reader_vbyte(r, &nbytes);
+	off += nbytes;
+
+	if(bits_base > 64 || bits_off > 64)
+		return NULL;
+
+	PEFReader* p = malloc(sizeof(*p));
+	if(!p)
+		return NULL;
+
+	p->r = *r;
+	p->n = n;
+	p->bits_base = bits_base;
+	p->bits_off = bits_off;
+	p->dir_off = 8 * off;
+	p->data_off = 8 * (off + BYTE_LEN(DIVUP(n, PEF_CHUNK) * (bits_base + bits_off)));
+	p->data_len = data_len;
+
+	return p;
+}
+
+void pef_destroy(PEFReader* p) {
+	free(p);
+}
+
+typedef struct {
+	uint64_t base; // first element
+	uint64_t n; // number of elements
+	int type;
+	FileOff off; // bit offset of the data after the type
+	FileOff len; // number of bits of the data after the type
+} Chunk;
+
+static inline uint64_t read_bits(Reader* r, int n) {
+	return n ? reader_readint(r, n) : 0;
+}
+
+static void chunk_get(PEFReader* p, uint64_t c, Chunk* ch) {
+	uint64_t chunks = DIVUP(p->n, PEF_CHUNK);
+	int entry = p->bits_base + p->bits_off;
+
+	Reader r = p->r;
+	reader_bitpos(&r, p->dir_off + c * entry);
+	ch->base = read_bits(&r, p->bits_base);
+	FileOff off = read_bits(&r, p->bits_off);
+
+	// the data of the chunk end at the offset of the next chunk
+	FileOff end = p->data_len;
+	if(c + 1 < chunks) {
+		reader_bitpos(&r, p->dir_off + (c + 1) * entry + p->bits_base);
+		end = read_bits(&r, p->bits_off);
+	}
+
+	reader_bitpos(&r, p->data_off + off);
+	ch->type = reader_readint(&r, PEF_TYPE_BITS);
+	ch->n = MIN(PEF_CHUNK, p->n - c * PEF_CHUNK);
+	ch->off = p->data_off + off + PEF_TYPE_BITS;
+	ch->len = end - off - PEF_TYPE_BITS;
+}
+
+// Returns the position of the j-th one (starting at 0) of the next `len` bits of the reader, or `len` if it does not exist.
+static uint64_t select_bits(Reader* r, FileOff len, uint64_t j) {
+	for(FileOff pos = 0; pos < len; pos += 64) {
+		int n = MIN(64, len - pos);
+		uint64_t w = word_reverse(reader_readint(r, n) << (64 - n)); // the first bit at the lowest bit
+
+		uint64_t ones = POPCNT64(w);
+		if(j < ones)
+			return pos + select_bit64(w, j);
+		j -= ones;
+	}
+
+	return len;
+}
+
+// Returns the number of ones of the next `len` bits of the reader.
+static uint64_t rank_bits(Reader* r, FileOff len) {
+	uint64_t ones = 0;
+	for(FileOff pos = 0; pos < len; pos += 64)
+		ones += POPCNT64(reader_readint(r, MIN(64, len - pos)));
+
+	return ones;
+}
+
+static uint64_t chunk_value(PEFReader* p, Chunk* ch, uint64_t j) {
+	Reader r = p->r;
+	reader_bitpos(&r, ch->off);
+
+	switch(ch->type) {
+	case PEF_RUN:
+		return ch->base;
+	case PEF_DENSE:
+		return ch->base + select_bits(&r, ch->len, j);
+	case PEF_EF: {
+		int l = reader_readint(&r, PEF_LOWBITS_BITS);
+		FileOff off_hi = PEF_LOWBITS_BITS + ch->n * l;
+
+		reader_bitpos(&r, ch->off + PEF_LOWBITS_BITS + j * l);
+		uint64_t low = read_bits(&r, l);
+
+		reader_bitpos(&r, ch->off + off_hi);
+		uint64_t high = select_bits(&r, ch->len - off_hi, j) - j;
+
+		return ch->base + (high << l | low);
+	}
+	default:
+		panic("unknown chunk type %d", ch->type);
+		return 0;
+	}
+}
+
+uint64_t pef_get(PEFReader* p, uint64_t i) {
+	if(i >= p->n)
+		panic("index %" PRIu64 " exceeds the length %" PRIu64, i, p->n);
+
+	Chunk ch;
+	chunk_get(p, i / PEF_CHUNK, &ch);
+	return chunk_value(p, &ch, i % PEF_CHUNK);
+}
+
+// Returns the index of the first element of the chunk with a value of at least x, or the number of elements.
+static uint64_t chunk_successor(PEFReader* p, Chunk* ch, uint64_t x) {
+	if(x <= ch->base)
+		return 0;
+
+	uint64_t rel = x - ch->base;
+
+	Reader r = p->r;
+	reader_bitpos(&r, ch->off);
+
+	switch(ch->type) {
+	case PEF_RUN:
+		return ch->n;
+	case PEF_DENSE: // the number of values smaller than x
+		return rel >= ch->len ? ch->n : rank_bits(&r, rel);
+	case PEF_EF: {
+		int l = reader_readint(&r, PEF_LOWBITS_BITS);
+
+		Reader lo = r;
+		reader_bitpos(&r, ch->off + PEF_LOWBITS_BITS + ch->n * l);
+
+		// the elements are decoded sequentially, because the chunks are small
+		uint64_t high = 0;
+		for(uint64_t j = 0; j < ch->n;) {
+			if(!reader_readbit(&r)) {
+				high++;
+				continue;
+			}
+
+			if((high << l | read_bits(&lo, l)) >= rel)
+				return j;
+			j++;
+		}
+
+		return ch->n;
+	}
+	default:
+		panic("unknown chunk type %d", ch->type);
+		return 0;
+	}
+}
+
+uint64_t pef_successor(PEFReader* p, uint64_t x) {
+	uint64_t chunks = DIVUP(p->n, PEF_CHUNK);
+
+	// binary search of the first chunk with a first element of at least x
+	uint64_t lo = 0, hi = chunks;
+	while(lo < hi) {
+		uint64_t mid = (lo + hi) / 2;
+
+		Reader r = p->r;
+		reader_bitpos(&r, p->dir_off + mid * (p->bits_base + p->bits_off));
+		if(read_bits(&r, p->bits_base) < x)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	// the successor is in the previous chunk or it is the first element of the chunk
+	if(lo > 0) {
+		Chunk ch;
+		chunk_get(p, lo - 1, &ch);
+
+		uint64_t j = chunk_successor(p, &ch, x);
+		if(j < ch.n)
+			return (lo - 1) * PEF_CHUNK + j;
+	}
+
+	return MIN(lo * PEF_CHUNK, p->n);
+}
+
+void pef_iter(PEFReader* p, CGraphEdgeLabel label, CGraphEdgeLabel first_nt, PEFIterator* it) {
+	it->n = p->n;
+	it->nt = pef_successor(p, first_nt);
+	it->has_next = true;
+
+	if(label < first_nt) {
+		it->i = pef_successor(p, label);
+		it->end = pef_successor(p, label + 1);
+		it->in_nt = false;
+	}
+	else { // all edges of the non-terminals
+		it->i = it->nt;
+		it->end = it->n;
+		it->in_nt = true;
+	}
+}
+
+int pef_iter_next(PEFIterator* it, uint64_t* v) {
+	if(!it->has_next)
+		return -1;
+
+	if(it->i >= it->end && !it->in_nt) { // continue with the edges of the non-terminals
+		it->i = it->nt;
+		it->end = it->n;
+		it->in_nt = true;
+	}
+
+	if(it->i >= it->end) {
+		pef_iter_finish(it);
+		return 0;
+	}
+
+	*v = it->i++;
+	return 1;
+}
+
+void pef_iter_finish(PEFIterator* it) {
+	it->has_next = false;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file pef.h
+ * @author FR
+ */
+
+#ifndef PEF_H
+#define PEF_H
+
+#include <stdbool.h>
+#include <reader.h>
+#include <cgraph.h>
+
+// Reader of a sorted list with a partitioned Elias-Fano encoding.
+typedef struct {
+	Reader r;
+
+	uint64_t n;
+	int bits_base; // bit width of the first element of a chunk
+	int bits_off; // bit width of the offset of a chunk
+	FileOff dir_off; // bit offset of the directory
+	FileOff data_off; // bit offset of the data of the chunks
+	uint64_t data_len;
+} PEFReader;
+
+PEFReader* pef_init(Reader* r);
+void pef_destroy(PEFReader* p);
+
+#define pef_len(p) ((p)->n)
+uint64_t pef_get(PEFReader* p, uint64_t i);
+// Returns the index of the first element with a value of at least x, or the length if no such element exists.
+uint64_t pef_successor(PEFReader* p, uint64_t x);
+
+// Iterates the indices of the elements with the value `label`, followed by the indices of all elements of at least `first_nt`,
+// like the EliasFanoIterator.
+typedef struct {
+	uint64_t i;
+	uint64_t end; // end of the current range
+	uint64_t nt; // first element of the non-terminals
+	uint64_t n;
+	bool in_nt; // iterating the elements of the non-terminals
+	bool has_next;
+} PEFIterator;
+
+void pef_iter(PEFReader* p, CGraphEdgeLabel label, CGraphEdgeLabel first_nt, PEFIterator* it);
+
+// return value:
+// 1: next element exists
+// 0: no next element exists
+// -1: error occured
+int pef_iter_next(PEFIterator* it, uint64_t* v);
+void pef_iter_finish(PEFIterator* it);
+
+#endif
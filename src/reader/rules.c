@@ -6,6 +6,7 @@
 #include "rules.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 #include <reader.h>
 #include <panic.h>
@@ -25,47 +26,135 @@ RulesReader* rules_init(Reader* r) {
 
 	FileOff offdata = off + lentable;
 
-	Reader rt;
+	Reader rt, rd;
 	reader_init(r, &rt, off);
-	EliasFanoReader* table = eliasfano_init(&rt);
-	if(!table)
+	reader_init(r, &rd, offdata);
+
+	return rules_init_parts(first_nt, rule_count, &rt, &rd);
+}
+
+RulesReader* rules_init_parts(uint64_t first_nt, uint64_t rule_count, Reader* table, const Reader* rules) {
+	EliasFanoReader* t = eliasfano_init(table);
+	if(!t)
 		return NULL;
 
 	RulesReader* rr = malloc(sizeof(*rr));
 	if(!rr) {
-		eliasfano_destroy(table);
+		eliasfano_destroy(t);
 		return NULL;
 	}
 
-	rr->r = *r;
+	rr->r = *rules;
 	rr->first_nt = first_nt;
 	rr->rule_count = rule_count;
-	rr->table = table;
-	rr->off_rules = 8 * offdata;
+	rr->table = t;
+	rr->off = NULL;
+	rr->edges = NULL;
 
 	return rr;
 }
 
 void rules_destroy(RulesReader* r) {
 	eliasfano_destroy(r->table);
+	if(r->edges) {
+		free(r->off);
+		free(r->edges);
+	}
 	free(r);
 }
 
+int rules_decode(RulesReader* r) {
+	uint64_t* off = malloc((r->rule_count + 1) * sizeof(*off));
+	if(!off)
+		return -1;
+
+	size_t cap = 8 * (r->rule_count + 1), len = 0; // a rule usually has two edges of rank two
+	uint64_t* edges = malloc(cap * sizeof(*edges));
+	if(!edges)
+		goto err0;
+
+	// the offsets are increasing, so they are decoded sequentially
+	EliasFanoCursor c;
+	eliasfano_cursor(r->table, 0, &c);
+
+	for(uint64_t i = 0; i < r->rule_count; i++) {
+		uint64_t bitoff;
+		if(!eliasfano_cursor_next(&c, &bitoff))
+			goto err1;
+
+		Reader rr = r->r;
+		reader_bitpos(&rr, bitoff);
+
+		int num_edges = reader_eliasdelta(&rr);
+		if(num_edges > MAX_RULE_SIZE)
+			goto err1;
+
+		off[i] = len;
+		for(int j = 0; j < num_edges; j++) {
+			uint64_t label = reader_eliasdelta(&rr);
+			uint64_t rank = reader_eliasdelta(&rr);
+			if(rank > RANK_MAX)
+				goto err1;
+
+			if(len + 2 + rank > cap) {
+				cap = 2 * cap + 2 + rank;
+				uint64_t* tmp = realloc(edges, cap * sizeof(*edges));
+				if(!tmp)
+					goto err1;
+				edges = tmp;
+			}
+
+			edges[len++] = label;
+			edges[len++] = rank;
+			for(uint64_t k = 0; k < rank; k++)
+				edges[len++] = reader_eliasdelta(&rr);
+		}
+	}
+	off[r->rule_count] = len;
+
+	r->off = off;
+	r->edges = edges;
+	return 0;
+
+err1:
+	free(edges);
+err0:
+	free(off);
+	return -1;
+}
+
 int rules_get(RulesReader* r, uint64_t nt, StEdge* e) {
 	uint64_t i = nt - r->first_nt;
 	if(i < 0 || i >= r->rule_count)
 		panic("no rule found for non-terminal %" PRIu64, nt);
 
+	if(r->edges) {
+		const uint64_t* d = r->edges + r->off[i];
+		const uint64_t* end = r->edges + r->off[i + 1];
+
+		int num_edges = 0;
+		for(; d < end; num_edges++) {
+			StEdge* ej = e + num_edges;
+			ej->label = d[0];
+			ej->rank = d[1];
+			memcpy(ej->nodes, d + 2, ej->rank * sizeof(*d));
+			d += 2 + ej->rank;
+		}
+
+		return num_edges;
+	}
+
 	FileOff bitoff = eliasfano_get(r->table, i);
-	reader_bitpos(&r->r, r->off_rules + bitoff);
+	Reader rr = r->r;
+	reader_bitpos(&rr, bitoff);
 
-	int num_edges = reader_eliasdelta(&r->r);
+	int num_edges = reader_eliasdelta(&rr);
 
 	if(num_edges > MAX_RULE_SIZE) // panic because we only have memory for MAX_RULE_SIZE edges :(
 		panic("rule with %d edges found but expected a maximum of %d", num_edges, MAX_RULE_SIZE);
 
 	for(int j = 0; j < num_edges; j++)
-		edge_read(&r->r, e + j);
+		edge_read(&rr, e + j);
 
 	return num_edges;
 }
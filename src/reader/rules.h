@@ -18,15 +18,22 @@
 #define MAX_RULE_SIZE (RANK_MAX / 2)
 
 typedef struct {
-	Reader r;
+	Reader r; // reader at the start of the concatted rules
 	uint64_t first_nt;
 	uint64_t rule_count;
 	EliasFanoReader* table;
-	FileOff off_rules;
+
+	// The rules decoded into the memory, only set if the tables are decoded when opening the graph
+	uint64_t* off; // offset of the first edge of each rule in `edges`, followed by the end of the last rule
+	uint64_t* edges; // label, rank and nodes of each edge
 } RulesReader;
 
 RulesReader* rules_init(Reader* r);
+// Initializes the rules with a reader for the offset table and the rules, as stored in the sections of the file.
+RulesReader* rules_init_parts(uint64_t first_nt, uint64_t rule_count, Reader* table, const Reader* rules);
 void rules_destroy(RulesReader* r);
+// Decodes all rules into the memory, so `rules_get` does not read the file anymore.
+int rules_decode(RulesReader* r);
 
 int rules_get(RulesReader* r, uint64_t nt, StEdge* e);
 
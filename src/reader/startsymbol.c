@@ -28,21 +28,14 @@ StartSymbolReader* startsymbol_init(Reader* r) {
 	FileOff offifsedge = offlabels + lenlabels;
 	FileOff offifs = offifsedge + lenifsedge;
 
-	Reader rt;
-	reader_init(r, &rt, off);
-	K2Reader* matrix = k2_init(&rt);
-	if(!matrix)
-		return NULL;
-
-	reader_init(r, &rt, offlabels); // reusing the reader
-	EliasFanoReader* labels = eliasfano_init(&rt);
-	if(!labels)
-		goto err0;
+	Reader rm, rl, re, rt, ri;
+	reader_init(r, &rm, off);
+	reader_init(r, &rl, offlabels);
 
 	reader_bytepos(r, offifsedge);
 
 	int edge_ifs_n = reader_vbyte(r, &nbytes);
-	FileOff edge_ifs_off = offifsedge + nbytes;
+	reader_init(r, &re, offifsedge + nbytes);
 
 	reader_bytepos(r, offifs);
 
@@ -50,8 +43,27 @@ StartSymbolReader* startsymbol_init(Reader* r) {
 	FileOff offtable = offifs + nbytes;
 	FileOff offdata = offtable + tmp;
 
-	reader_init(r, &rt, offtable); // reusing the reader
-	EliasFanoReader* table = eliasfano_init(&rt);
+	reader_init(r, &rt, offtable);
+	reader_init(r, &ri, offdata);
+
+	return startsymbol_init_parts(&rm, &rl, false, edge_ifs_n, &re, &rt, &ri);
+}
+
+StartSymbolReader* startsymbol_init_parts(Reader* matrix, Reader* labels, bool labels_pef, int edge_ifs_n, const Reader* edge_ifs, Reader* ifs_table, const Reader* ifs) {
+	K2Reader* m = k2_init(matrix);
+	if(!m)
+		return NULL;
+
+	EliasFanoReader* l = NULL;
+	PEFReader* lp = NULL;
+	if(labels_pef)
+		lp = pef_init(labels);
+	else
+		l = eliasfano_init(labels);
+	if(!l && !lp)
+		goto err0;
+
+	EliasFanoReader* table = eliasfano_init(ifs_table);
 	if(!table)
 		goto err1;
 
@@ -59,14 +71,20 @@ StartSymbolReader* startsymbol_init(Reader* r) {
 	if(!s)
 		goto err2;
 
-	s->r = *r;
-	s->matrix = matrix;
-	s->labels = labels;
+	s->matrix = m;
+	s->labels = l;
+	s->labels_pef = lp;
 	s->edge_ifs.n = edge_ifs_n;
-	s->edge_ifs.off = 8 * edge_ifs_off;
+	s->edge_ifs.r = *edge_ifs;
 	s->ifs.table = table;
-	s->ifs.off = 8 * offdata;
+	s->ifs.r = *ifs;
+	s->ifs.off = NULL;
+	s->ifs.data = NULL;
+	s->edge_nodes.table = NULL;
+	s->degrees = NULL;
+	s->postings.list = NULL;
 	s->nt_table = NULL;
+	s->nt_summary = NULL;
 	s->terminals = 0;
 
 	return s;
@@ -74,19 +92,171 @@ StartSymbolReader* startsymbol_init(Reader* r) {
 err2:
 	eliasfano_destroy(table);
 err1:
-	eliasfano_destroy(labels);
+	if(l)
+		eliasfano_destroy(l);
+	else
+		pef_destroy(lp);
 err0:
-	k2_destroy(matrix);
+	k2_destroy(m);
 	return NULL;
 }
 
+int startsymbol_init_edge_nodes(StartSymbolReader* s, Reader* table, Reader* nodes) {
+	size_t nbytes;
+	int n = reader_vbyte(nodes, &nbytes);
+	if(n < 1 || n > 64)
+		return -1;
+
+	EliasFanoReader* t = eliasfano_init(table);
+	if(!t)
+		return -1;
+
+	s->edge_nodes.table = t;
+	s->edge_nodes.n = n;
+	reader_init(nodes, &s->edge_nodes.r, nbytes);
+
+	return 0;
+}
+
+int startsymbol_init_degrees(StartSymbolReader* s, Reader* r) {
+	s->degrees = eliasfano_init(r);
+	return s->degrees ? 0 : -1;
+}
+
+#define edge_count(s) ((s)->labels ? (s)->labels->n : pef_len((s)->labels_pef))
+
+// returns the first edge with a label of at least `label`, the edges are sorted by their labels
+static uint64_t label_successor(StartSymbolReader* s, uint64_t label) {
+	if(!s->labels)
+		return pef_successor(s->labels_pef, label);
+
+	EliasFanoCursor c;
+	return eliasfano_successor(s->labels, label, &c) ? c.i : s->labels->n;
+}
+
+int startsymbol_init_postings(StartSymbolReader* s, Reader* r, uint64_t first_nt) {
+	size_t nbytes;
+	uint64_t edges = reader_vbyte(r, &nbytes);
+
+	Reader rl;
+	reader_init(r, &rl, nbytes);
+	EliasFanoReader* list = eliasfano_init(&rl);
+	if(!list)
+		return -1;
+
+	s->postings.list = list;
+	s->postings.edges = edges;
+	s->postings.nt = label_successor(s, first_nt); // the NT edges follow the terminal edges
+	return 0;
+}
+
+int startsymbol_decode_ifs(StartSymbolReader* s) {
+	uint64_t n = s->ifs.table->n;
+
+	uint64_t* off = malloc((n + 1) * sizeof(*off));
+	if(!off)
+		return -1;
+
+	size_t cap = 4 * (n + 1), len = 0;
+	int* data = malloc(cap * sizeof(*data));
+	if(!data)
+		goto err0;
+
+	// the offsets are increasing, so they are decoded sequentially
+	EliasFanoCursor c;
+	eliasfano_cursor(s->ifs.table, 0, &c);
+
+	for(uint64_t i = 0; i < n; i++) {
+		uint64_t bitoff;
+		if(!eliasfano_cursor_next(&c, &bitoff))
+			goto err1;
+
+		Reader r = s->ifs.r;
+		reader_bitpos(&r, bitoff);
+
+		int rank = reader_eliasdelta(&r);
+		if(rank > RANK_MAX)
+			goto err1;
+
+		if(len + rank > cap) {
+			cap = 2 * cap + rank;
+			int* tmp = realloc(data, cap * sizeof(*data));
+			if(!tmp)
+				goto err1;
+			data = tmp;
+		}
+
+		off[i] = len;
+		for(int k = 0; k < rank; k++)
+			data[len++] = reader_eliasdelta(&r);
+	}
+	off[n] = len;
+
+	s->ifs.off = off;
+	s->ifs.data = data;
+	return 0;
+
+err1:
+	free(data);
+err0:
+	free(off);
+	return -1;
+}
+
 void startsymbol_destroy(StartSymbolReader* s) {
 	k2_destroy(s->matrix);
-	eliasfano_destroy(s->labels);
+	if(s->labels)
+		eliasfano_destroy(s->labels);
+	else
+		pef_destroy(s->labels_pef);
 	eliasfano_destroy(s->ifs.table);
+	if(s->ifs.data) {
+		free(s->ifs.off);
+		free(s->ifs.data);
+	}
+	if(s->edge_nodes.table)
+		eliasfano_destroy(s->edge_nodes.table);
+	if(s->degrees)
+		eliasfano_destroy(s->degrees);
+	if(s->postings.list)
+		eliasfano_destroy(s->postings.list);
 	free(s);
 }
 
+// returns the number of edges of the start symbol adjacent to the node
+static inline uint64_t node_degree(StartSymbolReader* s, uint64_t node) {
+	if(node + 1 >= s->degrees->n)
+		return 0;
+
+	EliasFanoCursor c;
+	uint64_t start, end;
+	eliasfano_cursor(s->degrees, node, &c);
+	if(!eliasfano_cursor_next(&c, &start) || !eliasfano_cursor_next(&c, &end))
+		return 0;
+
+	return end - start;
+}
+
+// Orders the bound nodes by their degrees and returns, if the rows of the nodes should be intersected.
+// The node with the lowest degree is iterated alone, if its degree is much lower than the degree of the others,
+// because then the edges of this node are checked faster than traversing the rows of the other nodes.
+static bool plan_rows(StartSymbolReader* s, uint64_t* rows, int m) {
+	uint64_t degrees[RANK_MAX];
+	for(int i = 0; i < m; i++) {
+		uint64_t v = rows[i], d = node_degree(s, v);
+
+		int j = i;
+		for(; j > 0 && degrees[j - 1] > d; j--) {
+			degrees[j] = degrees[j - 1];
+			rows[j] = rows[j - 1];
+		}
+		degrees[j] = d;
+		rows[j] = v;
+	}
+
+	return m > 1 && degrees[0] * PLAN_ROW_SKEW > degrees[1];
+}
+
 void startsymbol_neighborhood(StartSymbolReader* s, bool predicate_query, CGraphRank rank, CGraphEdgeLabel label, const CGraphNode* nodes, StartSymbolNeighborhood* n) {
 	n->s = s;
 //	if(node_src == node_dst)
@@ -122,43 +292,118 @@ void startsymbol_neighborhood(StartSymbolReader* s, bool predicate_query, CGraph
     {
         n->rank = CGRAPH_NODES_ALL;
     }
+    // without bound nodes, the edges of the label are iterated like a predicate query or all edges are scanned
+    n->scan_query = !predicate_query && next == 0 && label == CGRAPH_LABELS_ALL;
+    if (!predicate_query && next == 0)
+        predicate_query = label != CGRAPH_LABELS_ALL;
+
+    n->query_rank = nodes ? rank : CGRAPH_NODES_ALL;
+    n->query_nodes = nodes;
     n->predicate_query = predicate_query;
+    n->rows_query = false;
+    n->postings_query = predicate_query && s->postings.list && label != CGRAPH_LABELS_ALL && (uint64_t) label < s->terminals;
+    n->in_postings = false;
     n->label = label;
     if (predicate_query)
     {
-        eliasfano_iter(s->labels, label, s->terminals + 1, &n->efit);
+        if (s->labels)
+            eliasfano_iter(s->labels, label, s->terminals, &n->efit);
+        else
+            pef_iter(s->labels_pef, label, s->terminals, &n->pefit);
+    }
+    else if (n->scan_query)
+    {
+        n->scan = 0;
     }
 	else
     {
-        k2_iter_init_row(s->matrix, n->nodes[0], &n->it);
+        // with several bound nodes, the rows of the nodes are intersected
+        uint64_t rows[RANK_MAX];
+        int m = 0;
+        for (int i = 0; i < n->rank; i++)
+            if (n->nodes[i] != CGRAPH_NODES_ALL)
+                rows[m++] = n->nodes[i];
+
+        // with the degrees, the node with the lowest degree is the first one and the others are checked in the order of their degrees
+        bool intersect = m > 1;
+        if (s->degrees && m > 0) {
+            intersect = plan_rows(s, rows, m);
+            for (int i = 0; i < m; i++)
+                n->nodes[i] = rows[i];
+            n->rank = m;
+        }
+
+        n->rows_query = intersect && k2_rows_init(s->matrix, rows, m, &n->rit) == 0;
+        if (!n->rows_query)
+            k2_iter_init_row(s->matrix, n->nodes[0], &n->it);
     }
 }
 
 // return the id if the index function of a edge
 static inline int edge_ifs_get(StartSymbolReader* s, uint64_t edge) {
-	FileOff line_off = s->edge_ifs.off + s->edge_ifs.n * edge;
-	reader_bitpos(&s->r, line_off);
+	Reader r = s->edge_ifs.r;
+	reader_bitpos(&r, s->edge_ifs.n * edge);
 
-	return reader_readint(&s->r, s->edge_ifs.n);
+	return reader_readint(&r, s->edge_ifs.n);
 }
 
 // determine the index function of a edge
 // the memory where the index function is written to is given as a parameter
 // the number of elements is returned as the return type
 static inline int if_get(StartSymbolReader* s, int i, int* indf) {
+	if(s->ifs.data) {
+		int n = s->ifs.off[i + 1] - s->ifs.off[i];
+		memcpy(indf, s->ifs.data + s->ifs.off[i], n * sizeof(*indf));
+		return n;
+	}
+
 	FileOff off = eliasfano_get(s->ifs.table, i);
-	reader_bitpos(&s->r, s->ifs.off + off);
+	Reader r = s->ifs.r;
+	reader_bitpos(&r, off);
 
-	int n = reader_eliasdelta(&s->r);
+	int n = reader_eliasdelta(&r);
 	if(n > RANK_MAX)
 		panic("index function %d with a rank of %d exceeds the maximum rank of %d", i, n, RANK_MAX);
 
 	for(int k = 0; k < n; k++)
-		indf[k] = reader_eliasdelta(&s->r);
+		indf[k] = reader_eliasdelta(&r);
 
 	return n;
 }
 
+// determine the nodes of an edge in the order of its index function with the optional edge nodes
+// the number of nodes is returned or -1, if the data are invalid
+static inline int edge_nodes_get(StartSymbolReader* s, uint64_t e, uint64_t* nodes) {
+	EliasFanoCursor c;
+	uint64_t start, end;
+	eliasfano_cursor(s->edge_nodes.table, e, &c);
+	if(!eliasfano_cursor_next(&c, &start) || !eliasfano_cursor_next(&c, &end) || end - start > RANK_MAX)
+		return -1;
+
+	Reader r = s->edge_nodes.r;
+	reader_bitpos(&r, start * s->edge_nodes.n);
+	for(uint64_t j = 0; j < end - start; j++)
+		nodes[j] = reader_readint(&r, s->edge_nodes.n);
+
+	return end - start;
+}
+
+static inline bool edge_nodes_contains(const uint64_t* nodes, int rank, uint64_t node) {
+	for(int j = 0; j < rank; j++)
+		if(nodes[j] == node)
+			return true;
+	return false;
+}
+
+// checks with the optional summaries, if an edge of a NT may produce edges of the neighborhood
+static inline bool nt_summary_match(StartSymbolNeighborhood* n, uint64_t label, const uint64_t* nodes, int rank) {
+	StartSymbolReader* s = n->s;
+	if(label < s->terminals || !s->nt_summary)
+		return true;
+
+	return ntsummary_match(s->nt_summary, label - s->terminals, nodes, rank, n->query_rank, n->query_nodes);
+}
+
 // return value:
 // 1: edge should be considered
 // 0: edge can be ignored
@@ -168,7 +413,7 @@ static inline int get_edge(StartSymbolNeighborhood* n, uint64_t e, StEdge* edge)
 	StartSymbolReader* s = n->s;
 
 	// determining the label of the edge
-	uint64_t label = eliasfano_get(s->labels, e);
+	uint64_t label = s->labels ? eliasfano_get(s->labels, e) : pef_get(s->labels_pef, e);
 
 	if((expected_label = n->label) != CGRAPH_LABELS_ALL) {
 		uint64_t terminals = s->terminals;
@@ -178,24 +423,42 @@ static inline int get_edge(StartSymbolNeighborhood* n, uint64_t e, StEdge* edge)
 			if(label != expected_label)
 				return 0; // return 0, because the edge label does not match with the expected label
 		}
-		else {
+		else if(!n->in_postings) { // the NTs of the postings produce the label
 			K2Reader* nt_table;
 			if((nt_table = s->nt_table) && !k2_get(nt_table, label - terminals, expected_label))
 				return 0; // return 0, because the nt edge does not produces a edge with the expected label
 		}
 	}
 
+	if(s->edge_nodes.table) {
+		int rank = edge_nodes_get(s, e, edge->nodes);
+		if(rank < 0)
+			return -1;
+
+		// the bound nodes are searched in the nodes of the edge instead of the incidence matrix
+		for(int i = 0; i < n->rank && !n->rows_query; i++) {
+			if(n->nodes[i] != CGRAPH_NODES_ALL && !edge_nodes_contains(edge->nodes, rank, n->nodes[i]))
+				return 0;
+		}
+
+		if(!nt_summary_match(n, label, edge->nodes, rank))
+			return 0;
+
+		edge->label = label;
+		edge->rank = rank;
+		return 1;
+	}
+
 	// Check if the current edge is adjacent to all destination nodes.
-    for (int i = 0; i < n->rank; i++) {
+	// The edges of a row are adjacent to its node, so the node of the iterated row is skipped.
+    for (int i = n->predicate_query ? 0 : 1; i < n->rank && !n->rows_query; i++) {
         // edge is not adjacent to the destination node
         if (n->nodes[i] != CGRAPH_NODES_ALL && !k2_get(s->matrix, n->nodes[i], e))
             return 0;
     }
 
-	size_t c_len; // Number of nodes of the edge
-	uint64_t* nodes = k2_column(s->matrix, e, &c_len); // Should we check for NULL?
-	if(!nodes)
-		return -1;
+	uint64_t nodes[RANK_MAX];
+	size_t c_len = k2_column(s->matrix, e, nodes, RANK_MAX); // Number of nodes of the edge
 
 	int ix = edge_ifs_get(s, e); // Index of the index function
 
@@ -203,9 +466,14 @@ static inline int get_edge(StartSymbolNeighborhood* n, uint64_t e, StEdge* edge)
 	int i_len = if_get(s, ix, indx); // length of the index function
 
 	uint64_t nodes_order[RANK_MAX]; // We prealloc on the stack because our rank is limited to RANK_MAX
-	for(int j = 0; j < i_len; j++)
+	for(int j = 0; j < i_len; j++) {
+		if((size_t) indx[j] >= c_len)
+			return -1;
 		nodes_order[j] = nodes[indx[j]];
-	free(nodes);
+	}
+
+	if(!nt_summary_match(n, label, nodes_order, i_len))
+		return 0;
 
 	edge->label = label;
 	edge->rank = i_len;
@@ -213,10 +481,55 @@ static inline int get_edge(StartSymbolNeighborhood* n, uint64_t e, StEdge* edge)
 	return 1;
 }
 
+// positions the cursor of the postings at the NT edges producing the label
+static void postings_start(StartSymbolNeighborhood* n) {
+	StartSymbolReader* s = n->s;
+	n->in_postings = true;
+	n->postings_next = s->postings.list->n > 0 && eliasfano_successor(s->postings.list, n->label * s->postings.edges, &n->pc);
+}
+
+static int postings_next(StartSymbolNeighborhood* n, uint64_t* v) {
+	uint64_t edges = n->s->postings.edges, p;
+	if(!n->postings_next || !eliasfano_cursor_next(&n->pc, &p) || p >= (n->label + 1) * edges) {
+		n->postings_next = false;
+		return 0;
+	}
+
+	*v = p - n->label * edges;
+	return 1;
+}
+
 int startsymbol_neighborhood_next(StartSymbolNeighborhood* n, StEdge* edge) {
 	uint64_t neigh;
 	for(;;) {
-		switch(n->predicate_query ? eliasfano_iter_next(&n->efit, &neigh) : k2_iter_next(&n->it, &neigh)) {
+		int res;
+		if(n->in_postings)
+			res = postings_next(n, &neigh);
+		else if(n->rows_query)
+			res = k2_rows_next(&n->rit, &neigh);
+		else if(n->scan_query) {
+			neigh = n->scan++;
+			res = neigh < edge_count(n->s);
+		}
+		else if(!n->predicate_query)
+			res = k2_iter_next(&n->it, &neigh);
+		else if(n->s->labels)
+			res = eliasfano_iter_next(&n->efit, &neigh);
+		else
+			res = pef_iter_next(&n->pefit, &neigh);
+
+		// after the terminal edges with the label, the NT edges are iterated with the postings instead of the labels
+		if(res == 1 && n->postings_query && !n->in_postings && neigh >= n->s->postings.nt) {
+			if(n->s->labels)
+				eliasfano_iter_finish(&n->efit);
+			else
+				pef_iter_finish(&n->pefit);
+
+			postings_start(n);
+			res = postings_next(n, &neigh);
+		}
+
+		switch(res) {
 		case 0:
 			return 0;
 		case 1: {
@@ -238,10 +551,109 @@ int startsymbol_neighborhood_next(StartSymbolNeighborhood* n, StEdge* edge) {
 void startsymbol_neighborhood_finish(StartSymbolNeighborhood* n) {
     if (n->predicate_query)
     {
-        eliasfano_iter_finish(&n->efit);
+        if (n->s->labels)
+            eliasfano_iter_finish(&n->efit);
+        else
+            pef_iter_finish(&n->pefit);
     }
-    else
+    else if (n->rows_query)
+    {
+        k2_rows_finish(&n->rit);
+    }
+    else if (!n->scan_query) // the scan has no iterator
     {
         k2_iter_finish(&n->it);
     }
 }
+
+// returns the rank of an edge without decoding its nodes
+static int edge_rank(StartSymbolReader* s, uint64_t e) {
+	if(s->edge_nodes.table) {
+		EliasFanoCursor c;
+		uint64_t start, end;
+		eliasfano_cursor(s->edge_nodes.table, e, &c);
+		if(!eliasfano_cursor_next(&c, &start) || !eliasfano_cursor_next(&c, &end))
+			return -1;
+		return end - start;
+	}
+
+	int i = edge_ifs_get(s, e);
+	if(s->ifs.data)
+		return s->ifs.off[i + 1] - s->ifs.off[i];
+
+	Reader r = s->ifs.r;
+	reader_bitpos(&r, eliasfano_get(s->ifs.table, i));
+	return reader_eliasdelta(&r);
+}
+
+uint64_t startsymbol_count_terminals(StartSymbolReader* s, CGraphEdgeLabel label, CGraphRank rank) {
+	uint64_t start = 0, end = label_successor(s, s->terminals);
+	if(label != CGRAPH_LABELS_ALL) {
+		if((uint64_t) label >= s->terminals)
+			return 0;
+
+		start = label_successor(s, label);
+		end = label_successor(s, label + 1);
+	}
+
+	if(rank == CGRAPH_NODES_ALL)
+		return end - start;
+
+	uint64_t count = 0;
+	for(uint64_t e = start; e < end; e++)
+		if(edge_rank(s, e) == rank)
+			count++;
+
+	return count;
+}
+
+void startsymbol_nt_iter(StartSymbolReader* s, CGraphEdgeLabel label, StartSymbolNTIterator* it) {
+	it->s = s;
+	it->label = label;
+	it->postings = label != CGRAPH_LABELS_ALL && s->postings.list;
+	it->e = label_successor(s, s->terminals);
+
+	if(it->postings) {
+		if(s->postings.list->n == 0 || !eliasfano_successor(s->postings.list, label * s->postings.edges, &it->c))
+			it->e = edge_count(s); // no postings of the label
+	}
+	else if(s->labels)
+		eliasfano_cursor(s->labels, it->e, &it->c);
+}
+
+bool startsymbol_nt_iter_next(StartSymbolNTIterator* it, uint64_t* nt) {
+	StartSymbolReader* s = it->s;
+	uint64_t n = edge_count(s);
+
+	if(it->postings) {
+		uint64_t p, edges = s->postings.edges;
+		if(it->e >= n || !eliasfano_cursor_next(&it->c, &p) || p >= (it->label + 1) * edges) {
+			it->e = n;
+			return false;
+		}
+
+		uint64_t e = p - it->label * edges;
+		*nt = s->labels ? eliasfano_get(s->labels, e) : pef_get(s->labels_pef, e);
+		return true;
+	}
+
+	for(; it->e < n; it->e++) {
+		uint64_t l;
+		if(s->labels) {
+			if(!eliasfano_cursor_next(&it->c, &l))
+				return false;
+		}
+		else
+			l = pef_get(s->labels_pef, it->e);
+
+		// the NT table determines, if the NT produces an edge with the label
+		if(it->label != CGRAPH_LABELS_ALL && s->nt_table && !k2_get(s->nt_table, l - s->terminals, it->label))
+			continue;
+
+		it->e++;
+		*nt = l;
+		return true;
+	}
+
+	return false;
+}
@@ -10,31 +10,63 @@
 #include <reader.h>
 #include <edge.h>
 #include <eliasfano.h>
+#include <pef.h>
 #include <k2.h>
+#include <ntsummary.h>
 #include <cgraph.h>
 
 typedef struct {
-	Reader r;
-
 	K2Reader* matrix;
 	EliasFanoReader* labels;
+	PEFReader* labels_pef; // used instead of `labels`, if the labels are stored with the partitioned encoding
 
 	struct {
 		int n; // bits per value
-		FileOff off; // offset in the reader r
+		Reader r; // reader at the start of the values
 	} edge_ifs;
 
 	struct {
 		EliasFanoReader* table; // offset table
-		FileOff off; // offset in the reader r of the concatted data
+		Reader r; // reader at the start of the concatted data
+
+		// the index functions decoded into the memory, only set if the tables are decoded when opening the graph
+		uint64_t* off; // offset of each index function in `data`, followed by the end of the last one
+		int* data;
 	} ifs;
 
-	// The following two fields are only set, if the NT table exists
+	// The nodes of each edge in the order of its index function, only set if the optional sections exist
+	struct {
+		EliasFanoReader* table; // offsets of the edges
+		int n; // bits per node
+		Reader r; // reader at the start of the nodes
+	} edge_nodes;
+
+	EliasFanoReader* degrees; // optional prefix sums of the degrees of the nodes, used to plan the queries with several bound nodes
+
+	// The following fields are only set, if the NT table exists
 	K2Reader* nt_table; // note: memory is managed by the grammar reader
+	NTSummaryReader* nt_summary; // optional, also managed by the grammar reader
+
+	// The NT edges producing each terminal label, only set if the optional section exists
+	struct {
+		EliasFanoReader* list; // values `label * edges + edge`
+		uint64_t edges; // number of edges
+		uint64_t nt; // first NT edge
+	} postings;
 	uint64_t terminals;
 } StartSymbolReader;
 
 StartSymbolReader* startsymbol_init(Reader* r);
+// Initializes the start symbol with a reader for each part, as stored in the sections of the file.
+StartSymbolReader* startsymbol_init_parts(Reader* matrix, Reader* labels, bool labels_pef, int edge_ifs_n, const Reader* edge_ifs, Reader* ifs_table, const Reader* ifs);
+// Adds the optional nodes of the edges, so the edges are decoded without the incidence matrix and the index functions.
+int startsymbol_init_edge_nodes(StartSymbolReader* s, Reader* table, Reader* nodes);
+// Adds the optional degrees of the nodes, so the neighborhood of several bound nodes is determined with the node of the lowest degree.
+int startsymbol_init_degrees(StartSymbolReader* s, Reader* r);
+// Adds the optional postings of the terminal labels, so a predicate query only iterates the NT edges producing the label.
+int startsymbol_init_postings(StartSymbolReader* s, Reader* r, uint64_t first_nt);
+// Decodes all index functions into the memory, so they are not read from the file anymore.
+int startsymbol_decode_ifs(StartSymbolReader* s);
 void startsymbol_destroy(StartSymbolReader* s);
 
 typedef struct {
@@ -43,11 +75,23 @@ typedef struct {
 	CGraphRank rank;
     CGraphEdgeLabel label;
     CGraphNode nodes[128];
+    // rank and nodes of the query with the nodes at their positions, used for the summaries of the NTs
+    CGraphRank query_rank;
+    const CGraphNode* query_nodes;
 
     bool predicate_query;
+    bool scan_query; // all edges are iterated, because no node and no label is bound
+    bool rows_query; // the edges adjacent to all bound nodes are iterated together
+    bool postings_query; // the NT edges are iterated with the postings of the label
+    bool in_postings; // the iteration switched from the terminal edges to the NT edges in the postings of the label
+    bool postings_next;
+    EliasFanoCursor pc; // cursor of the postings
 	union {
         K2Iterator it;
+        K2RowsIterator rit;
         EliasFanoIterator efit;
+        PEFIterator pefit;
+        uint64_t scan; // next edge of the scan
     };
 } StartSymbolNeighborhood;
 
@@ -61,4 +105,21 @@ void startsymbol_neighborhood(StartSymbolReader* s, bool predicate_query, CGraph
 int startsymbol_neighborhood_next(StartSymbolNeighborhood* n, StEdge* edge);
 void startsymbol_neighborhood_finish(StartSymbolNeighborhood* n); // needed if not iterated to the end
 
+// Counts the terminal edges of the start symbol with the label `label` and the rank `rank` without decoding their nodes.
+// The label and the rank may be unbound with `CGRAPH_LABELS_ALL` and `CGRAPH_NODES_ALL`.
+uint64_t startsymbol_count_terminals(StartSymbolReader* s, CGraphEdgeLabel label, CGraphRank rank);
+
+// Iterates the labels of the NT edges of the start symbol, which may produce an edge with the label `label`.
+typedef struct {
+	StartSymbolReader* s;
+	CGraphEdgeLabel label;
+	bool postings; // the edges are iterated with the postings of the label
+	uint64_t e; // next edge, if the postings are not used
+	EliasFanoCursor c; // cursor of the labels or of the postings
+} StartSymbolNTIterator;
+
+void startsymbol_nt_iter(StartSymbolReader* s, CGraphEdgeLabel label, StartSymbolNTIterator* it);
+// Returns false, if no further NT edge exists.
+bool startsymbol_nt_iter_next(StartSymbolNTIterator* it, uint64_t* nt);
+
 #endif
@@ -21,3 +21,10 @@ uint16_t table_short_bitmap(uint8_t class_offset, uint16_t inclass_offset) {
 		return (1 << BITS_PER_BLOCK) - 1;
 	return short_bitmaps[offset_class[class_offset] + inclass_offset];
 }
+
+uint32_t table_class_sizes(uint64_t types) {
+	uint32_t sum = 0;
+	for(int i = 0; i < 64; i += BLOCK_TYPE_BITS)
+		sum += class_sizes[(types >> i) & 0xf];
+	return sum;
+}
@@ -16,5 +16,7 @@
 uint8_t table_class_size(uint8_t n);
 uint16_t table_compute_offset(uint16_t v);
 uint16_t table_short_bitmap(uint8_t class_offset, uint16_t inclass_offset);
+// Sum of the class sizes of the 16 block types packed into the word.
+uint32_t table_class_sizes(uint64_t types);
 
 #endif
@@ -7,7 +7,14 @@
 
 #include <string.h>
 
-size_t popcnt(const uint8_t* data, size_t size) {
+#if defined(__x86_64__) && defined(__GNUC__)
+// The implementations for newer instruction sets are compiled with the target attribute
+// and are selected at runtime, so the library does not need to be built with -march=native.
+#define DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+static size_t popcnt_generic(const uint8_t* data, size_t size) {
 	size_t i = 0;
 	size_t cnt = 0;
 
@@ -57,6 +64,114 @@ size_t popcnt(const uint8_t* data, size_t size) {
 	return cnt;
 }
 
+#ifdef DISPATCH_X86
+__attribute__((target("popcnt")))
+static size_t popcnt_popcnt(const uint8_t* data, size_t size) {
+	size_t i = 0;
+	size_t cnt = 0;
+
+	uint64_t val;
+	for(; i + 8 <= size; i += 8) {
+		memcpy(&val, data + i, sizeof(val));
+		cnt += POPCNT64(val);
+	}
+
+	if(i < size) {
+		val = 0;
+		memcpy(&val, data + i, size - i);
+		cnt += POPCNT64(val);
+	}
+
+	return cnt;
+}
+
+// popcount of each 64 bit lane by looking up the nibbles
+__attribute__((target("avx2")))
+static inline __m256i popcnt256(__m256i v) {
+	const __m256i lookup = _mm256_setr_epi8(
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+	);
+	const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+	__m256i lo = _mm256_and_si256(v, low_mask);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+	__m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+
+	return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+// carry-save adder of three vectors
+#define CSA(h, l, a, b, c) do { \
+	__m256i u = _mm256_xor_si256((a), (b)); \
+	(h) = _mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256(u, (c))); \
+	(l) = _mm256_xor_si256(u, (c)); \
+} while(0)
+
+#define LOAD256(p) _mm256_loadu_si256((const __m256i*) (p))
+
+// Harley-Seal popcount of blocks of 512 bytes, see W. Mula, N. Kurz and D. Lemire: "Faster Population Counts Using AVX2 Instructions"
+__attribute__((target("avx2,popcnt")))
+static size_t popcnt_avx2(const uint8_t* data, size_t size) {
+	if(size < 512) // not worth setting up the adders
+		return popcnt_popcnt(data, size);
+
+	__m256i total = _mm256_setzero_si256();
+	__m256i ones = _mm256_setzero_si256();
+	__m256i twos = _mm256_setzero_si256();
+	__m256i fours = _mm256_setzero_si256();
+	__m256i eights = _mm256_setzero_si256();
+	__m256i sixteens, twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+
+	size_t i = 0;
+	for(; i + 512 <= size; i += 512) {
+		const uint8_t* d = data + i;
+
+		CSA(twos_a, ones, ones, LOAD256(d + 0), LOAD256(d + 32));
+		CSA(twos_b, ones, ones, LOAD256(d + 64), LOAD256(d + 96));
+		CSA(fours_a, twos, twos, twos_a, twos_b);
+		CSA(twos_a, ones, ones, LOAD256(d + 128), LOAD256(d + 160));
+		CSA(twos_b, ones, ones, LOAD256(d + 192), LOAD256(d + 224));
+		CSA(fours_b, twos, twos, twos_a, twos_b);
+		CSA(eights_a, fours, fours, fours_a, fours_b);
+		CSA(twos_a, ones, ones, LOAD256(d + 256), LOAD256(d + 288));
+		CSA(twos_b, ones, ones, LOAD256(d + 320), LOAD256(d + 352));
+		CSA(fours_a, twos, twos, twos_a, twos_b);
+		CSA(twos_a, ones, ones, LOAD256(d + 384), LOAD256(d + 416));
+		CSA(twos_b, ones, ones, LOAD256(d + 448), LOAD256(d + 480));
+		CSA(fours_b, twos, twos, twos_a, twos_b);
+		CSA(eights_b, fours, fours, fours_a, fours_b);
+		CSA(sixteens, eights, eights, eights_a, eights_b);
+
+		total = _mm256_add_epi64(total, popcnt256(sixteens));
+	}
+
+	total = _mm256_slli_epi64(total, 4);
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcnt256(eights), 3));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcnt256(fours), 2));
+	total = _mm256_add_epi64(total, _mm256_slli_epi64(popcnt256(twos), 1));
+	total = _mm256_add_epi64(total, popcnt256(ones));
+
+	size_t cnt = _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1)
+		+ _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+
+	return cnt + popcnt_popcnt(data + i, size - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+static size_t popcnt_avx512(const uint8_t* data, size_t size) {
+	__m512i total = _mm512_setzero_si512();
+
+	size_t i = 0;
+	for(; i + 64 <= size; i += 64)
+		total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(data + i)));
+
+	return _mm512_reduce_add_epi64(total) + popcnt_popcnt(data + i, size - i);
+}
+#endif
+
+size_t (*popcnt)(const uint8_t* data, size_t size) = popcnt_generic;
+
 static const uint8_t reverse_lookup[16] = {
 	0x0, 0x8, 0x4, 0xc, 0x2, 0xa, 0x6, 0xe,
 	0x1, 0x9, 0x5, 0xd, 0x3, 0xb, 0x7, 0xf
@@ -68,6 +183,15 @@ uint8_t byte_reverse(uint8_t n) {
 	return (reverse_lookup[n & 0b1111] << 4) | reverse_lookup[n >> 4];
 }
 
+// Reversing the bits in a word by swapping the bytes and reversing the bits within the bytes
+uint64_t word_reverse(uint64_t n) {
+	n = __builtin_bswap64(n);
+	n = ((n >> 1) & 0x5555555555555555ULL) | ((n & 0x5555555555555555ULL) << 1);
+	n = ((n >> 2) & 0x3333333333333333ULL) | ((n & 0x3333333333333333ULL) << 2);
+	n = ((n >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((n & 0x0f0f0f0f0f0f0f0fULL) << 4);
+	return n;
+}
+
 bool power_of(uint64_t x, uint64_t n) {
 	if(x < 1)
 		return false;
@@ -173,7 +297,7 @@ static inline uint32_t byte_counts(uint32_t x) {
 	return x;
 }
 
-unsigned int select_bit(uint32_t x, unsigned int k) {
+static unsigned int select_bit_generic(uint32_t x, unsigned int k) {
 	uint32_t byte_sums = byte_counts(x) * ONES_STEP_8;
 	const uint32_t k_step_8 = k * ONES_STEP_8;
 	const uint32_t geq_k_step_8 = (((k_step_8 | MSBS_STEP_8) - byte_sums) & MSBS_STEP_8);
@@ -181,4 +305,49 @@ unsigned int select_bit(uint32_t x, unsigned int k) {
 	const uint32_t byte_rank = k - (((byte_sums << 8) >> place) & (uint32_t)(0xff));
 	return place + select_in_byte[((x >> place) & 0xff) | (byte_rank << 8)];
 }
+
+static unsigned int select_bit64_generic(uint64_t x, unsigned int k) {
+	unsigned int lo = POPCNT32((uint32_t) x);
+	if(k < lo)
+		return select_bit_generic((uint32_t) x, k);
+	return 32 + select_bit_generic((uint32_t) (x >> 32), k - lo);
+}
+
+#ifdef DISPATCH_X86
+__attribute__((target("bmi2")))
+static unsigned int select_bit_bmi2(uint32_t x, unsigned int k) {
+	return __builtin_ctz(_pdep_u32(1U << k, x));
+}
+
+__attribute__((target("bmi2")))
+static unsigned int select_bit64_bmi2(uint64_t x, unsigned int k) {
+	return __builtin_ctzll(_pdep_u64(1ULL << k, x));
+}
+#endif
+
+unsigned int (*select_bit)(uint32_t value, unsigned int n) = select_bit_generic;
+unsigned int (*select_bit64)(uint64_t value, unsigned int n) = select_bit64_generic;
+#endif
+
+// Chooses the implementations for the instruction sets of this CPU once, when the library is loaded.
+__attribute__((constructor))
+static void arith_init(void) {
+#ifdef DISPATCH_X86
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx512vpopcntdq"))
+		popcnt = popcnt_avx512;
+	else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+		popcnt = popcnt_avx2;
+	else if(__builtin_cpu_supports("popcnt"))
+		popcnt = popcnt_popcnt;
+
+#ifndef __BMI2__
+	// PDEP is microcoded on AMD processors before Zen 3 and slower than the table based select
+	if(__builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2")) {
+		select_bit = select_bit_bmi2;
+		select_bit64 = select_bit64_bmi2;
+	}
+#endif
 #endif
+}
@@ -58,6 +58,7 @@
 // fast integer div up
 #define DIVUP(a, b) (((a) + (b) - 1) / (b))
 #define BYTE_LEN(n) DIVUP(n, 8)
+#define ALIGN(n, a) (DIVUP(n, a) * (a))
 
 #define _BIT_LEN(n) ((int) sizeof(uint64_t) * 8 - __builtin_clzll((uint64_t) (n)))
 #define BIT_LEN(n) ((n) == 0 ? 0 : _BIT_LEN(n))
@@ -75,17 +76,22 @@
 #define POPCNT32(b) (__builtin_popcount(b))
 #define POPCNT64(b) (__builtin_popcountll(b))
 
-size_t popcnt(const uint8_t* data, size_t size);
+// The implementations of popcnt and select_bit are chosen at runtime,
+// depending on the instruction sets of the CPU (AVX-512, AVX2, POPCNT and BMI2).
+extern size_t (*popcnt)(const uint8_t* data, size_t size);
 
 uint8_t byte_reverse(uint8_t n);
+uint64_t word_reverse(uint64_t n);
 bool power_of(uint64_t x, uint64_t n);
 
 #ifdef __BMI2__ // Optimize for BMI2 instruction set
 #include <x86intrin.h>
 
-#define select_bit(value, n) _tzcnt_u32(_pdep_u32(1U << (n), (value)))
+#define select_bit(value, n) __builtin_ctz(_pdep_u32(1U << (n), (value)))
+#define select_bit64(value, n) __builtin_ctzll(_pdep_u64(1ULL << (n), (value)))
 #else
-unsigned int select_bit(uint32_t value, unsigned int n);
+extern unsigned int (*select_bit)(uint32_t value, unsigned int n);
+extern unsigned int (*select_bit64)(uint64_t value, unsigned int n);
 #endif
 
 #endif
@@ -16,6 +16,37 @@
 // Default factor for bitsequences
 #define DEFAULT_FACTOR 8
 
+// Default sampling of the select hints of bit sequences, 0 disables the hints
+#define DEFAULT_SELECT_SAMPLE 0
+
+// Default parameter if bit sequences with interleaved rank counters are used
+#define DEFAULT_INTERLEAVED (false)
+
+// Default parameter if the edge labels of the start symbol are stored with a partitioned Elias-Fano encoding
+#define DEFAULT_PEF_LABELS (false)
+
+// Default parameter if the incidence matrix of the start symbol is stored as a hybrid k2-tree
+#define DEFAULT_K2_HYBRID (false)
+
+// Default parameter if the nodes of each edge of the start symbol are stored additionally
+#define DEFAULT_EDGE_NODES (false)
+
+// Default parameter if the summaries of the NTs are added to the NT table
+#define DEFAULT_NT_SUMMARY (false)
+
+// Default parameter if the postings of the NT edges for each terminal label are added to the NT table
+#define DEFAULT_LABEL_POSTINGS (false)
+
+// Default parameter if the number of terminal edges produced by each NT is stored to count the edges without decompression
+#define DEFAULT_NT_COUNTS (false)
+
+// Default parameter if the degrees of the nodes in the start symbol are stored for planning the neighborhood queries
+#define DEFAULT_DEGREES (false)
+
+// The rows of several bound nodes are intersected, unless the lowest degree is smaller by this factor than the next one.
+// Then the edges of the node with the lowest degree are iterated and checked for the other nodes.
+#define PLAN_ROW_SKEW 8
+
 // Default sampling value for the dictionary
 #define DEFAULT_SAMPLING 32
 
@@ -30,16 +61,90 @@
 #define DEFAULT_RRR (true)
 #endif
 
+// Default memory budget of the block cache, if the graph is not read with mmap
+#define DEFAULT_CACHE_SIZE (16 << 20)
+
+// Default number of independently locked shards of the block cache
+#define DEFAULT_CACHE_SHARDS 16
+
+// Default number of blocks read ahead after sequential cache misses
+#define DEFAULT_CACHE_READAHEAD 4
+#define CACHE_MAX_READAHEAD 64
+
+// Default memory budget of the cache of the expanded NTs in bytes, 0 disables the cache
+#define DEFAULT_NT_CACHE_SIZE 0
+
+// Maximum number of words of an expanded NT in the cache and the expected average size of an entry in bytes
+#define NT_CACHE_MAX_LEN (1 << 14)
+#define NT_CACHE_AVG_ENTRY 256
+
 // Magic number of the compressed graph file
 #define MAGIC_GRAPH "CGRAPH1\x00"
 #define MAGIC_GRAPH_LEN (strlen(MAGIC_GRAPH) + 1)
 
+// Magic number of the compressed graph file of version 2, which stores its data in aligned sections.
+// The magic is followed by the number of sections and a directory entry (id, byte offset, byte length) per section.
+// All numbers of the directory are stored as 8-byte big endian integers.
+#define MAGIC_GRAPH_V2 "CGRAPH2\x00"
+#define MAGIC_GRAPH_V2_LEN (strlen(MAGIC_GRAPH_V2) + 1)
+
+// Alignment of the sections in bytes, so word and SIMD loads never cross a cache line unnecessarily
+#define SECTION_ALIGN 64
+
+// Ids of the sections of a graph file of version 2
+#define SECTION_GRAMMAR 0x1 // node count, flags and the small values of the grammar
+#define SECTION_MATRIX 0x2 // incidence matrix of the start symbol
+#define SECTION_LABELS 0x3 // edge labels of the start symbol
+#define SECTION_EDGE_IFS 0x4 // id of the index function of each edge of the start symbol
+#define SECTION_IFS_TABLE 0x5 // offsets of the index functions
+#define SECTION_IFS 0x6 // index functions
+#define SECTION_RULES_TABLE 0x7 // offsets of the rules
+#define SECTION_RULES 0x8 // rules
+#define SECTION_NT_TABLE 0x9 // optional NT table
+#define SECTION_DICT 0xa // dictionary
+#define SECTION_LABELS_PEF 0xb // edge labels of the start symbol with a partitioned Elias-Fano encoding, replaces SECTION_LABELS
+#define SECTION_EDGE_NODES_TABLE 0xc // optional offsets of the nodes of each edge of the start symbol
+#define SECTION_EDGE_NODES 0xd // optional nodes of each edge of the start symbol in the order of its index function
+#define SECTION_NT_SUMMARY 0xe // optional summaries of the terminal edges of each NT, extends the NT table
+#define SECTION_DEGREES 0xf // optional prefix sums of the degrees of the nodes in the start symbol
+#define SECTION_LABEL_POSTINGS 0x10 // optional NT edges of the start symbol producing each terminal label, extends the NT table
+#define SECTION_NT_COUNTS 0x11 // optional number of terminal edges of each label and rank produced by each NT
+
+// Upper bound of the section ids, unknown sections with larger ids are ignored by the reader
+#define SECTION_COUNT 32
+
+// Number of elements per chunk of the partitioned Elias-Fano encoding
+#define PEF_CHUNK 128
+
+// Encodings of the chunks of the partitioned Elias-Fano encoding, stored in PEF_TYPE_BITS bits
+#define PEF_TYPE_BITS 2
+#define PEF_RUN 0x0 // all elements are equal to the first element, nothing is stored
+#define PEF_DENSE 0x1 // strictly increasing elements as a bitmap of the values relative to the first element
+#define PEF_EF 0x2 // Elias-Fano encoding of the values relative to the first element
+#define PEF_LOWBITS_BITS 6 // bit width of the number of lower bits of PEF_EF
+
+// A hybrid k2-tree splits its upper, dense levels with k = 2^K2_HYBRID_TOP_BITS and the lower levels with k = 2.
+// The number of upper levels is chosen, so the matrix has at least as many edges as submatrices at these levels.
+// The leaves are submatrices of size 2^K2_HYBRID_LEAF_BITS, stored as a word of L.
+#define K2_HYBRID_TOP_BITS 3
+#define K2_HYBRID_LEAF_BITS 3
+
+// The summary of a NT contains a triple (rank, position, node) for every terminal edge of this rank, that is produced by the NT
+// and contains the node of the NT at this position. The triple is stored as a column of the k2-tree with the NTs as rows.
+#define NT_SUMMARY_COLUMN(rank, pos, node, max_rank) ((((uint64_t) (rank) * (max_rank)) + (pos)) * (max_rank) + (node))
+
 // Magic byte for regular bit sequences
 #define BITSEQUENCE_REGULAR 0x1
 
 // Magic byte for bit sequences from paper "Practical Implementation of Rank and Select Queries"
 #define BITSEQUENCE_RG 0x2
 
+// Magic byte for RG bit sequences with the position of every k-th one and zero as select hints
+#define BITSEQUENCE_RG_SELECT 0x4
+
+// Magic byte for bit sequences with the rank counters and the data words interleaved in lines of 64 bytes
+#define BITSEQUENCE_INTERLEAVED 0x5
+
 #ifdef RRR
 // Magic byte for bit sequences from paper "Succinct Indexable Dictionaries with Applications to Encoding k-ary Trees, Prefix Sums and Multisets"
 #define BITSEQUENCE_RRR 0x3
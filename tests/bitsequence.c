@@ -0,0 +1,196 @@
+/**
+ * @file bitsequence.c
+ * @author FR
+ *
+ * Test of the encodings of the bit sequences, whose queries are compared with the bits of the bit array.
+ * Every encoding is read from the file, decoded in memory and read from a buffer,
+ * which is not aligned, so the interleaved lines cannot be used directly.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <arith.h>
+#include <constants.h>
+#include <writer.h>
+#include <reader.h>
+#include <bitsequence_r.h>
+
+#include "common.h"
+
+// lengths of the sequences, the first one is written without super blocks
+static const size_t lengths[] = { 150, 1000, 4099, 70000 };
+
+// probability of a one in 1/64
+static const int densities[] = { 0, 1, 32, 63, 64 };
+
+typedef struct {
+	const char* name;
+	BitsequenceParams p;
+} Encoding;
+
+static const Encoding encodings[] = {
+	{ "RG", { .factor = 4 } },
+	{ "RG with factor 20", { .factor = 20 } },
+	{ "RG with select hints", { .factor = 4, .select_sample = 32 } },
+	{ "RG with sparse select hints", { .factor = 20, .select_sample = 1024 } },
+	{ "interleaved", { .factor = 4, .interleaved = true } },
+#ifdef RRR
+	{ "RRR", { .factor = 4, .rrr = true } },
+	{ "RRR with factor 20", { .factor = 20, .rrr = true } },
+#endif
+};
+
+#define LENGTHS (sizeof(lengths) / sizeof(*lengths))
+#define DENSITIES (sizeof(densities) / sizeof(*densities))
+#define ENCODINGS (sizeof(encodings) / sizeof(*encodings))
+
+static void generate(BitArray* b, size_t len, int density) {
+	bitarray_init(b, len);
+	for(size_t i = 0; i < len; i++)
+		bitarray_set(b, i, (int) (test_random() % 64) < density);
+}
+
+// reads the file into a buffer, that starts 8 bytes after an aligned address
+static uint8_t* read_unaligned(const char* path, size_t* len) {
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	*len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t* data = aligned_alloc(SECTION_ALIGN, ALIGN(*len + 8, SECTION_ALIGN));
+	if(data && fread(data + 8, 1, *len, f) != *len) {
+		free(data);
+		data = NULL;
+	}
+
+	fclose(f);
+	return data;
+}
+
+static void check_sequence(BitsequenceReader* s, const BitArray* b, const char* name) {
+	size_t len = bitarray_len(b);
+	uint64_t ones = bitarray_count(b, 0, len, true);
+
+	if(!CHECK(bitsequence_reader_len(s) == len && bitsequence_reader_ones(s) == ones)) {
+		fprintf(stderr, "%s: length %zu\n", name, len);
+		return;
+	}
+
+	size_t failures = 0;
+	uint64_t rank = 0;
+	int64_t prev = -1;
+	for(size_t i = 0; i < len; i++) {
+		bool bit = bitarray_get(b, i);
+		if(bit) {
+			rank++;
+			prev = i;
+			failures += !CHECK(bitsequence_reader_select1(s, rank) == (int64_t) i);
+		}
+		else
+			failures += !CHECK(bitsequence_reader_select0(s, i + 1 - rank) == (int64_t) i);
+
+		failures += !CHECK(bitsequence_reader_access(s, i) == bit);
+		failures += !CHECK(bitsequence_reader_rank1(s, i) == rank);
+		failures += !CHECK(bitsequence_reader_rank0(s, i) == i + 1 - rank);
+		failures += !CHECK(bitsequence_reader_selectprev1(s, i) == prev);
+	}
+
+	for(size_t k = 0; k < (len + 63) / 64; k++) {
+		uint64_t w = 0;
+		for(size_t i = 64 * k; i < len && i < 64 * k + 64; i++)
+			w |= (uint64_t) bitarray_get(b, i) << (i % 64);
+		failures += !CHECK(bitsequence_reader_word(s, k) == w);
+	}
+
+	failures += !CHECK(bitsequence_reader_rank1(s, -1) == 0);
+	failures += !CHECK(bitsequence_reader_select1(s, 0) == -1);
+	failures += !CHECK(bitsequence_reader_select1(s, ones + 1) == -1);
+	failures += !CHECK(bitsequence_reader_select0(s, len - ones + 1) == -1);
+
+	if(failures)
+		fprintf(stderr, "%s: %zu failures with length %zu and %" PRIu64 " ones\n", name, failures, len, ones);
+}
+
+int main() {
+	char* path = test_tmpfile();
+	if(!path)
+		return EXIT_FAILURE;
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	BitArray bits[LENGTHS][DENSITIES];
+	FileOff off[LENGTHS][DENSITIES][ENCODINGS];
+	for(size_t i = 0; i < LENGTHS; i++) {
+		for(size_t j = 0; j < DENSITIES; j++) {
+			generate(&bits[i][j], lengths[i], densities[j]);
+
+			// every sequence is aligned like a section
+			for(size_t e = 0; e < ENCODINGS; e++) {
+				while(bitwriter_len(&w) % (8 * SECTION_ALIGN) != 0)
+					bitwriter_write_bit(&w, 0);
+
+				off[i][j][e] = bitwriter_len(&w) / 8;
+				if(bitwriter_write_bitsequence(&w, &bits[i][j], &encodings[e].p) < 0) {
+					fprintf(stderr, "failed to write %s\n", encodings[e].name);
+					return EXIT_FAILURE;
+				}
+			}
+		}
+	}
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	size_t len;
+	uint8_t* data = read_unaligned(path, &len);
+	if(!data) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	// the file, the file decoded in memory and the unaligned buffer
+	for(int mode = 0; mode < 3; mode++) {
+		FileReader* fr = mode < 2 ? filereader_init(path, NULL) : filereader_init_buffer(data + 8, len);
+		if(!fr) {
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		fr->in_memory = mode == 1;
+
+		for(size_t i = 0; i < LENGTHS; i++) {
+			for(size_t j = 0; j < DENSITIES; j++) {
+				for(size_t e = 0; e < ENCODINGS; e++) {
+					Reader r;
+					reader_initf(fr, &r, off[i][j][e]);
+					BitsequenceReader* s = bitsequence_reader_init(&r);
+					if(!CHECK(s != NULL))
+						continue;
+
+					check_sequence(s, &bits[i][j], encodings[e].name);
+					bitsequence_reader_destroy(s);
+				}
+			}
+		}
+
+		filereader_close(fr);
+	}
+
+	for(size_t i = 0; i < LENGTHS; i++)
+		for(size_t j = 0; j < DENSITIES; j++)
+			bitarray_destroy(&bits[i][j]);
+
+	free(data);
+	unlink(path);
+	free(path);
+
+	return test_result("bitsequence");
+}
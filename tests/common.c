@@ -0,0 +1,374 @@
+/**
+ * @file common.c
+ * @author FR
+ */
+
+#include "common.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#define MAX_REPORTS 20 // number of failed checks, that are reported
+
+static size_t checks = 0;
+static size_t failures = 0;
+
+static uint64_t next_random(uint64_t* s) {
+	// xorshift64
+	*s ^= *s << 13;
+	*s ^= *s >> 7;
+	*s ^= *s << 17;
+	return *s;
+}
+
+bool test_check(bool c, const char* expr, const char* file, int line) {
+	checks++;
+	if(!c && failures++ < MAX_REPORTS)
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+
+	return c;
+}
+
+uint64_t test_random() {
+	static uint64_t s = 88172645463325252ULL;
+	return next_random(&s);
+}
+
+int test_result(const char* name) {
+	printf("%s: %zu checks, %zu failed\n", name, checks, failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+char* test_tmpfile() {
+	char path[] = "/tmp/cgraph-test-XXXXXX";
+	int fd = mkstemp(path);
+	if(fd < 0) {
+		perror("mkstemp");
+		return NULL;
+	}
+	close(fd);
+
+	return strdup(path);
+}
+
+uint64_t* test_list(int kind, size_t* n) {
+	static const size_t lengths[TEST_LISTS] = { 1, 1000, 5000, 3000, 4000, 200 };
+	*n = lengths[kind];
+
+	uint64_t* list = malloc(*n * sizeof(*list));
+	if(!list)
+		return NULL;
+
+	uint64_t v = kind == 5 ? 1000000 : 0;
+	for(size_t i = 0; i < *n; i++) {
+		switch(kind) {
+		case 1: // few labels
+			v += test_random() % 100 == 0;
+			break;
+		case 2: // strictly increasing
+			v += 1 + (test_random() % 8 == 0);
+			break;
+		case 3: // sparse
+			v += test_random() % 1000000;
+			break;
+		case 4: // runs, dense parts and gaps
+			if(i % 500 < 200)
+				v += test_random() % 50 == 0;
+			else if(i % 500 < 400)
+				v++;
+			else
+				v += test_random() % 100000;
+			break;
+		}
+
+		list[i] = v;
+	}
+
+	return list;
+}
+
+static int write_graph(const char* path, size_t nodes, size_t labels, size_t edges, TestParams p) {
+	CGraphW* w = cgraphw_init();
+	if(!w)
+		return -1;
+
+	int res = -1;
+
+	if(p) {
+		CGraphCParams params;
+		cgraphw_get_params(w, &params);
+		p(&params);
+		cgraphw_set_params(w, &params);
+	}
+
+	// most edges have one of two labels and their first node is one of a quarter of the nodes,
+	// so the same digrams occur often
+	uint64_t s = 88172645463325252ULL;
+	char label[32], node[TEST_RANK - 1][32];
+	const char* n[TEST_RANK - 1];
+	for(size_t i = 0; i < edges; i++) {
+		size_t l = next_random(&s) % 4 == 0 ? next_random(&s) % labels : next_random(&s) % 2;
+		snprintf(label, sizeof(label), "l%zu", l);
+
+		snprintf(node[0], sizeof(node[0]), "n%zu", (size_t) (next_random(&s) % (nodes / 4 + 1)));
+		snprintf(node[1], sizeof(node[1]), "n%zu", (size_t) (next_random(&s) % nodes));
+		n[0] = node[0];
+		n[1] = node[1];
+
+		if(cgraphw_add_edge(w, TEST_RANK, label, n, i) < 0)
+			goto exit;
+	}
+
+	for(size_t i = 0; i < nodes; i++) {
+		snprintf(node[0], sizeof(node[0]), "n%zu", i);
+		if(cgraphw_add_node(w, node[0]) < 0)
+			goto exit;
+	}
+
+	if(cgraphw_compress(w, edges) < 0)
+		goto exit;
+	if(cgraphw_write(w, path, false) < 0)
+		goto exit;
+
+	res = 0;
+
+exit:
+	cgraphw_destroy(w);
+	return res;
+}
+
+int test_graph_init(TestGraph* t, size_t nodes, size_t labels, size_t edges, TestParams p, const CGraphRParams* rp) {
+	memset(t, 0, sizeof(*t));
+
+	t->path = test_tmpfile();
+	if(!t->path)
+		return -1;
+	if(write_graph(t->path, nodes, labels, edges, p) < 0)
+		goto err;
+
+	t->g = cgraphr_init_params(t->path, rp);
+	if(!t->g)
+		goto err;
+
+	t->node_count = nodes;
+	t->label_count = labels;
+	t->edge_count = edges;
+	t->nodes = malloc(nodes * sizeof(*t->nodes));
+	t->labels = malloc(labels * sizeof(*t->labels));
+	t->edges = malloc(edges * sizeof(*t->edges));
+	if(!t->nodes || !t->labels || !t->edges)
+		goto err;
+
+	char name[32];
+	for(size_t i = 0; i < nodes; i++) {
+		snprintf(name, sizeof(name), "n%zu", i);
+		t->nodes[i] = cgraphr_locate_node(t->g, name);
+	}
+	for(size_t i = 0; i < labels; i++) {
+		snprintf(name, sizeof(name), "l%zu", i);
+		t->labels[i] = cgraphr_locate_edge_label(t->g, name);
+	}
+
+	// the edges are generated again with the ids of the reader
+	uint64_t s = 88172645463325252ULL;
+	for(size_t i = 0; i < edges; i++) {
+		TestEdge* e = &t->edges[i];
+		size_t l = next_random(&s) % 4 == 0 ? next_random(&s) % labels : next_random(&s) % 2;
+
+		e->rank = TEST_RANK;
+		e->label = t->labels[l];
+		e->nodes[0] = t->nodes[next_random(&s) % (nodes / 4 + 1)];
+		e->nodes[1] = t->nodes[next_random(&s) % nodes];
+		e->nodes[2] = i;
+	}
+
+	return 0;
+
+err:
+	test_graph_destroy(t);
+	return -1;
+}
+
+void test_graph_destroy(TestGraph* t) {
+	if(t->g)
+		cgraphr_destroy(t->g);
+	if(t->path) {
+		unlink(t->path);
+		free(t->path);
+	}
+
+	free(t->nodes);
+	free(t->labels);
+	free(t->edges);
+	memset(t, 0, sizeof(*t));
+}
+
+static bool matches(const TestEdge* e, const TestEdge* q) {
+	if(q->rank != -1 && e->rank != q->rank)
+		return false;
+	if(q->label != CGRAPH_LABELS_ALL && e->label != q->label)
+		return false;
+	if(q->rank == -1)
+		return true;
+
+	for(int i = 0; i < q->rank && i < TEST_RANK; i++)
+		if(q->nodes[i] != CGRAPH_NODES_ALL && e->nodes[i] != q->nodes[i])
+			return false;
+
+	return true;
+}
+
+static int cmp_edge(const void* a, const void* b) {
+	const TestEdge* e1 = a;
+	const TestEdge* e2 = b;
+
+	if(e1->rank != e2->rank)
+		return e1->rank < e2->rank ? -1 : 1;
+	if(e1->label != e2->label)
+		return e1->label < e2->label ? -1 : 1;
+	for(int i = 0; i < TEST_RANK; i++)
+		if(e1->nodes[i] != e2->nodes[i])
+			return e1->nodes[i] < e2->nodes[i] ? -1 : 1;
+
+	return 0;
+}
+
+// returns the sorted edges of the iterator, edges of another rank are stored with the rank and label only
+static TestEdge* collect(CGraphEdgeIterator* it, size_t* len) {
+	size_t cap = 64;
+	TestEdge* edges = malloc(cap * sizeof(*edges));
+	*len = 0;
+
+	CGraphEdge e;
+	while(it && cgraphr_edges_next(it, &e)) {
+		if(*len == cap) {
+			cap *= 2;
+			edges = realloc(edges, cap * sizeof(*edges));
+		}
+
+		TestEdge* d = &edges[(*len)++];
+		memset(d, 0, sizeof(*d));
+		d->rank = e.rank;
+		d->label = e.label;
+		if(e.rank == TEST_RANK)
+			memcpy(d->nodes, e.nodes, sizeof(d->nodes));
+
+		free(e.nodes);
+	}
+
+	qsort(edges, *len, sizeof(*edges), cmp_edge);
+	return edges;
+}
+
+static bool equal(const TestEdge* e1, size_t len1, const TestEdge* e2, size_t len2) {
+	if(len1 != len2)
+		return false;
+
+	for(size_t i = 0; i < len1; i++)
+		if(cmp_edge(&e1[i], &e2[i]) != 0)
+			return false;
+
+	return true;
+}
+
+size_t test_graph_count(TestGraph* t, const TestEdge* q) {
+	size_t n = 0;
+	for(size_t i = 0; i < t->edge_count; i++)
+		if(matches(&t->edges[i], q))
+			n++;
+
+	return n;
+}
+
+bool test_graph_edges(TestGraph* t, CGraphEdgeIterator* it, const TestEdge* q) {
+	size_t len;
+	TestEdge* edges = collect(it, &len);
+
+	// the generated edges matching the query, sorted like the edges of the iterator
+	TestEdge* expected = malloc((t->edge_count + 1) * sizeof(*expected));
+	size_t n = 0;
+	for(size_t i = 0; i < t->edge_count; i++)
+		if(matches(&t->edges[i], q))
+			expected[n++] = t->edges[i];
+	qsort(expected, n, sizeof(*expected), cmp_edge);
+
+	bool res = equal(edges, len, expected, n);
+	if(!res)
+		fprintf(stderr, "query (rank %" PRId64 ", label %" PRId64 ", nodes %" PRId64 " %" PRId64 " %" PRId64 "): %zu edges, expected %zu\n",
+			q->rank, q->label, q->nodes[0], q->nodes[1], q->nodes[2], len, n);
+
+	free(edges);
+	free(expected);
+	return res;
+}
+
+// compares the query with the generated edges and the result of the base graph
+static void check_query(TestGraph* t, TestGraph* base, const TestEdge* q) {
+	CHECK(test_graph_edges(t, cgraphr_edges(t->g, q->rank, q->label, q->nodes), q));
+	if(!base)
+		return;
+
+	size_t len1, len2;
+	TestEdge* e1 = collect(cgraphr_edges(t->g, q->rank, q->label, q->nodes), &len1);
+	TestEdge* e2 = collect(cgraphr_edges(base->g, q->rank, q->label, q->nodes), &len2);
+	CHECK(equal(e1, len1, e2, len2));
+	free(e1);
+	free(e2);
+}
+
+void test_graph_queries(TestGraph* t, TestGraph* base) {
+	TestEdge q;
+
+	// a bound node at each position of the edges, with and without a label
+	for(size_t i = 0; i < t->node_count; i += 3) {
+		for(int p = 0; p < TEST_RANK - 1; p++) {
+			q = (TestEdge) { TEST_RANK, CGRAPH_LABELS_ALL, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+			q.nodes[p] = t->nodes[i];
+			check_query(t, base, &q);
+
+			q.label = t->labels[i % t->label_count];
+			check_query(t, base, &q);
+		}
+	}
+
+	// the index of an edge
+	for(size_t i = 0; i < t->edge_count; i += 17) {
+		q = (TestEdge) { TEST_RANK, CGRAPH_LABELS_ALL, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, i } };
+		check_query(t, base, &q);
+	}
+
+	// two bound nodes of an existing edge and of a mostly missing edge
+	for(size_t i = 0; i < t->edge_count; i += 7) {
+		const TestEdge* e = &t->edges[i];
+		q = (TestEdge) { TEST_RANK, CGRAPH_LABELS_ALL, { e->nodes[0], e->nodes[1], CGRAPH_NODES_ALL } };
+		check_query(t, base, &q);
+
+		q.label = e->label;
+		check_query(t, base, &q);
+
+		q.nodes[1] = t->nodes[(i * 31) % t->node_count];
+		check_query(t, base, &q);
+
+		CHECK(cgraphr_edge_exists(t->g, TEST_RANK, e->label, e->nodes));
+	}
+
+	// all edges of each label, with the predicate query and with a query without bound nodes
+	for(size_t i = 0; i < t->label_count; i++) {
+		q = (TestEdge) { -1, t->labels[i], { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+		CHECK(test_graph_edges(t, cgraphr_edges_by_predicate(t->g, q.label), &q));
+
+		q.rank = TEST_RANK;
+		check_query(t, base, &q);
+	}
+
+	q = (TestEdge) { TEST_RANK, CGRAPH_LABELS_ALL, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+	check_query(t, base, &q);
+	CHECK(test_graph_edges(t, cgraphr_edges_connecting(t->g, q.rank, q.nodes), &q));
+
+	// no edges of another rank
+	q = (TestEdge) { TEST_RANK - 1, CGRAPH_LABELS_ALL, { t->nodes[0], CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+	check_query(t, base, &q);
+}
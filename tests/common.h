@@ -0,0 +1,130 @@
+/**
+ * @file common.h
+ * @author FR
+ *
+ * Helpers of the tests, which generate small graphs and compare the results of the queries
+ * with a brute force search over the generated edges and with the results of a graph compressed with the defaults.
+ */
+
+#ifndef TESTS_COMMON_H
+#define TESTS_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <cgraph.h>
+
+// Checks the condition and reports it with its position, if it does not hold
+#define CHECK(c) test_check((c), #c, __FILE__, __LINE__)
+
+// Rank of the generated edges, the last node of an edge is its index like in the RDF graphs
+#define TEST_RANK 3
+
+/**
+ * An edge of a generated graph with the ids of the reader.
+ * Also used as a query, where -1 matches every rank, label and node.
+ */
+typedef struct {
+	CGraphRank rank;
+	CGraphEdgeLabel label;
+	CGraphNode nodes[TEST_RANK];
+} TestEdge;
+
+/**
+ * A generated graph, which is compressed and opened with the reader.
+ */
+typedef struct {
+	CGraphR* g;
+	char* path;
+
+	size_t edge_count;
+	TestEdge* edges;
+
+	// ids of the nodes "n<i>" and the labels "l<i>"
+	size_t node_count;
+	CGraphNode* nodes;
+	size_t label_count;
+	CGraphEdgeLabel* labels;
+} TestGraph;
+
+// Changes the default parameters of the compression
+typedef void (*TestParams)(CGraphCParams* p);
+
+/**
+ * Counts the check and reports it, if it failed.
+ *
+ * @return The condition.
+ */
+bool test_check(bool c, const char* expr, const char* file, int line);
+
+/**
+ * Returns the next number of a fixed pseudorandom sequence, so the tests are reproducible.
+ */
+uint64_t test_random();
+
+/**
+ * Prints the number of checks and failures.
+ *
+ * @return `EXIT_SUCCESS` if no check failed, otherwise `EXIT_FAILURE`.
+ */
+int test_result(const char* name);
+
+/**
+ * Creates an empty temporary file.
+ *
+ * @return Path of the file, which must be freed, or `NULL`.
+ */
+char* test_tmpfile();
+
+// Number of the kinds of generated lists
+#define TEST_LISTS 6
+
+/**
+ * Generates a sorted list like the labels of the start symbol with runs, dense and sparse parts.
+ *
+ * @param kind Kind of the list, less than `TEST_LISTS`.
+ * @param n Length of the list.
+ * @return The list, which must be freed.
+ */
+uint64_t* test_list(int kind, size_t* n);
+
+/**
+ * Generates a graph with frequent patterns, so RePair creates rules, compresses and opens it.
+ * The same sizes generate the same graph, so graphs compressed with different parameters have the same ids.
+ *
+ * @param t The graph.
+ * @param nodes Number of nodes.
+ * @param labels Number of edge labels.
+ * @param edges Number of edges.
+ * @param p Changes the parameters of the compression, may be `NULL` to use the defaults.
+ * @param rp Parameters of the reader, may be `NULL`.
+ * @return 0 on success, otherwise -1.
+ */
+int test_graph_init(TestGraph* t, size_t nodes, size_t labels, size_t edges, TestParams p, const CGraphRParams* rp);
+
+/**
+ * Closes the graph and deletes its file.
+ */
+void test_graph_destroy(TestGraph* t);
+
+/**
+ * Returns the number of the generated edges matching the query.
+ */
+size_t test_graph_count(TestGraph* t, const TestEdge* q);
+
+/**
+ * Checks, that the iterator returns the generated edges matching the query.
+ * The iterator is consumed.
+ *
+ * @return `true` if the edges are equal.
+ */
+bool test_graph_edges(TestGraph* t, CGraphEdgeIterator* it, const TestEdge* q);
+
+/**
+ * Runs queries with bound nodes, labels and without bound nodes and compares them with the generated edges.
+ * If `base` is given, the results are also compared with the results of the same queries on `base`,
+ * which is the same graph compressed with other parameters.
+ */
+void test_graph_queries(TestGraph* t, TestGraph* base);
+
+#endif
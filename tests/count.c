@@ -0,0 +1,90 @@
+/**
+ * @file count.c
+ * @author FR
+ *
+ * Test of the counting of the edges, which must return the number of edges of the same query with `cgraphr_edges`.
+ * The graph is compressed with the defaults and with the counts of the NTs, which are used if no node is bound.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "common.h"
+
+#define NODES 300
+#define LABELS 6
+#define EDGES 3000
+
+static int64_t count_edges(CGraphEdgeIterator* it) {
+	int64_t n = 0;
+
+	CGraphEdge e;
+	while(it && cgraphr_edges_next(it, &e)) {
+		free(e.nodes);
+		n++;
+	}
+
+	return n;
+}
+
+static void check_count(TestGraph* t, const TestEdge* q) {
+	int64_t n = cgraphr_edges_count(t->g, q->rank, q->label, q->nodes);
+	CHECK(n == (int64_t) test_graph_count(t, q));
+	CHECK(n == count_edges(cgraphr_edges(t->g, q->rank, q->label, q->nodes)));
+}
+
+static void check_counts(TestGraph* t) {
+	TestEdge q;
+
+	// a bound node at each position of the edges, with and without a label
+	for(size_t i = 0; i < t->node_count; i += 5) {
+		for(int p = 0; p < TEST_RANK - 1; p++) {
+			q = (TestEdge) { TEST_RANK, CGRAPH_LABELS_ALL, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+			q.nodes[p] = t->nodes[i];
+			check_count(t, &q);
+
+			q.label = t->labels[i % t->label_count];
+			check_count(t, &q);
+		}
+	}
+
+	// two bound nodes
+	for(size_t i = 0; i < t->edge_count; i += 11) {
+		const TestEdge* e = &t->edges[i];
+		q = (TestEdge) { TEST_RANK, e->label, { e->nodes[0], e->nodes[1], CGRAPH_NODES_ALL } };
+		check_count(t, &q);
+	}
+
+	// no bound node, which are counted with the counts of the NTs
+	for(int64_t l = -1; l < (int64_t) t->label_count; l++) {
+		CGraphEdgeLabel label = l < 0 ? CGRAPH_LABELS_ALL : t->labels[l];
+		for(CGraphRank rank = TEST_RANK - 1; rank <= TEST_RANK + 1; rank++) {
+			q = (TestEdge) { rank, label, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+			check_count(t, &q);
+			CHECK(cgraphr_edges_count(t->g, rank, label, NULL) == (int64_t) test_graph_count(t, &q));
+		}
+
+		// every rank
+		q = (TestEdge) { -1, label, { CGRAPH_NODES_ALL, CGRAPH_NODES_ALL, CGRAPH_NODES_ALL } };
+		CHECK(cgraphr_edges_count(t->g, -1, label, NULL) == (int64_t) test_graph_count(t, &q));
+	}
+}
+
+static void nt_counts(CGraphCParams* p) {
+	p->nt_counts = true;
+}
+
+int main() {
+	TestGraph base, t;
+	if(test_graph_init(&base, NODES, LABELS, EDGES, NULL, NULL) < 0 || test_graph_init(&t, NODES, LABELS, EDGES, nt_counts, NULL) < 0) {
+		fprintf(stderr, "failed to compress the graph\n");
+		return EXIT_FAILURE;
+	}
+
+	check_counts(&base);
+	check_counts(&t);
+
+	test_graph_destroy(&base);
+	test_graph_destroy(&t);
+
+	return test_result("count");
+}
@@ -0,0 +1,189 @@
+/**
+ * @file eliasfano.c
+ * @author FR
+ *
+ * Test of the Elias-Fano lists, whose sequential cursor, successor and iterator of the labels are compared
+ * with the elements of the list and with the random access of `eliasfano_get`.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <constants.h>
+#include <writer.h>
+#include <reader.h>
+#include <eliasfano.h>
+#include <eliasfano_list.h>
+
+#include "common.h"
+
+// index of the first element with a value of at least x
+static size_t lower_bound(const uint64_t* list, size_t n, uint64_t x) {
+	size_t lo = 0, hi = n;
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if(list[mid] < x)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static void check_successor(EliasFanoReader* e, const uint64_t* list, size_t n) {
+	EliasFanoCursor c;
+	uint64_t v;
+
+	for(size_t i = 0; i <= n; i += 1 + n / 500) {
+		// the element, its predecessor and successor value and the value after the last element
+		uint64_t x = i < n ? list[i] : list[n - 1] + 1;
+		for(uint64_t y = x > 0 ? x - 1 : x; y <= x + 1; y++) {
+			size_t k = lower_bound(list, n, y);
+
+			bool found = eliasfano_successor(e, y, &c);
+			if(!CHECK(found == (k < n)) || !found)
+				continue;
+
+			CHECK(c.i == k && eliasfano_cursor_next(&c, &v) && v == list[k]);
+		}
+	}
+}
+
+static void check_iter(EliasFanoReader* e, const uint64_t* list, size_t n) {
+	// the labels are followed by the non-terminals, which start at the last quarter of the list
+	uint64_t first_nt = list[3 * n / 4];
+
+	for(size_t i = 0; i < n; i += 1 + n / 50) {
+		for(uint64_t label = list[i]; label <= list[i] + 1 && label < first_nt; label++) {
+			EliasFanoIterator it;
+			eliasfano_iter(e, label, first_nt, &it);
+
+			size_t k = 0;
+			uint64_t v;
+			while(eliasfano_iter_next(&it, &v) == 1) {
+				while(k < n && list[k] != label && list[k] < first_nt)
+					k++;
+				if(!CHECK(k < n && v == k))
+					break;
+				k++;
+			}
+
+			// no edges of the label or the non-terminals are missing
+			while(k < n && list[k] != label && list[k] < first_nt)
+				k++;
+			CHECK(k == n);
+		}
+	}
+}
+
+static void check_list(EliasFanoReader* e, const uint64_t* list, size_t n) {
+	if(!CHECK(e->n == n))
+		return;
+
+	for(size_t i = 0; i < n; i++)
+		CHECK(eliasfano_get(e, i) == list[i]);
+
+	// cursors from several positions to the end of the list
+	EliasFanoCursor c;
+	uint64_t v;
+	for(size_t i = 0; i < n; i += 1 + n / 7) {
+		eliasfano_cursor(e, i, &c);
+		for(size_t j = i; j < n; j++)
+			CHECK(eliasfano_cursor_next(&c, &v) && v == list[j]);
+		CHECK(!eliasfano_cursor_next(&c, &v));
+	}
+
+	// skipping to values in the list, between the elements and after the last element,
+	// k is the index of the next element of the cursor
+	for(size_t i = 0; i < n; i += 1 + n / 100) {
+		eliasfano_cursor(e, i, &c);
+		size_t k = i;
+		for(size_t j = i; j < n; j += 1 + (test_random() % 64)) {
+			uint64_t x = list[j] + (test_random() % 2 ? 0 : test_random() % 1000);
+			while(k < n && list[k] < x)
+				k++;
+
+			bool found = eliasfano_cursor_next_geq(&c, x, &v);
+			if(!CHECK(found == (k < n)) || !found)
+				break;
+
+			CHECK(v == list[k] && c.i - 1 == k);
+			k++;
+		}
+	}
+
+	eliasfano_cursor(e, n, &c);
+	CHECK(!eliasfano_cursor_next(&c, &v));
+
+	check_successor(e, list, n);
+	check_iter(e, list, n);
+}
+
+int main() {
+	char* path = test_tmpfile();
+	if(!path)
+		return EXIT_FAILURE;
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	BitsequenceParams params[] = { { .factor = 4 }, { .factor = 4, .interleaved = true } };
+	size_t params_count = sizeof(params) / sizeof(*params);
+
+	uint64_t* lists[TEST_LISTS];
+	size_t lens[TEST_LISTS];
+	FileOff off[TEST_LISTS][2];
+	for(int i = 0; i < TEST_LISTS; i++) {
+		lists[i] = test_list(i, &lens[i]);
+
+		for(size_t j = 0; j < params_count; j++) {
+			while(bitwriter_len(&w) % (8 * SECTION_ALIGN) != 0)
+				bitwriter_write_bit(&w, 0);
+
+			off[i][j] = bitwriter_len(&w) / 8;
+			if(eliasfano_write(lists[i], lens[i], &w, &params[j]) < 0) {
+				fprintf(stderr, "failed to write the list\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	for(int in_memory = 0; in_memory <= 1; in_memory++) {
+		FileReader* fr = filereader_init(path, NULL);
+		if(!fr) {
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		fr->in_memory = in_memory;
+
+		for(int i = 0; i < TEST_LISTS; i++) {
+			for(size_t j = 0; j < params_count; j++) {
+				Reader r;
+				reader_initf(fr, &r, off[i][j]);
+				EliasFanoReader* e = eliasfano_init(&r);
+				if(!CHECK(e != NULL))
+					continue;
+
+				check_list(e, lists[i], lens[i]);
+				eliasfano_destroy(e);
+			}
+		}
+
+		filereader_close(fr);
+	}
+
+	for(int i = 0; i < TEST_LISTS; i++)
+		free(lists[i]);
+
+	unlink(path);
+	free(path);
+
+	return test_result("eliasfano");
+}
@@ -0,0 +1,138 @@
+/**
+ * @file format.c
+ * @author FR
+ *
+ * Test of the graph file of version 2, whose sections must be aligned, ascending and within the file.
+ * The queries of the compressed graph are compared with the generated edges,
+ * and the graph read from an aligned buffer must return the same edges as the graph read from the file.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <arith.h>
+#include <constants.h>
+
+#include "common.h"
+
+#define NODES 300
+#define LABELS 6
+#define EDGES 3000
+
+static uint64_t read_be64(const uint8_t* p) {
+	uint64_t v = 0;
+	for(int i = 0; i < 8; i++)
+		v = (v << 8) | p[i];
+
+	return v;
+}
+
+static uint8_t* read_file(const char* path, size_t* len) {
+	FILE* f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+
+	uint8_t* data = NULL;
+	if(fseek(f, 0, SEEK_END) < 0)
+		goto exit;
+
+	long size = ftell(f);
+	if(size < 0 || fseek(f, 0, SEEK_SET) < 0)
+		goto exit;
+
+	// the buffer is aligned like a mapped file, so the interleaved lines are used directly
+	*len = size;
+	data = aligned_alloc(SECTION_ALIGN, ALIGN(*len, SECTION_ALIGN));
+	if(data && fread(data, 1, *len, f) != *len) {
+		free(data);
+		data = NULL;
+	}
+
+exit:
+	fclose(f);
+	return data;
+}
+
+static void check_sections(const uint8_t* data, size_t len) {
+	if(!CHECK(len >= MAGIC_GRAPH_V2_LEN + 8 && memcmp(data, MAGIC_GRAPH_V2, MAGIC_GRAPH_V2_LEN) == 0))
+		return;
+
+	uint64_t n = read_be64(data + MAGIC_GRAPH_V2_LEN);
+	uint64_t dir_end = MAGIC_GRAPH_V2_LEN + 8 * (1 + 3 * n);
+	if(!CHECK(n > 0 && n <= SECTION_COUNT && dir_end <= len))
+		return;
+
+	bool exists[SECTION_COUNT] = {0};
+	uint64_t prev_id = 0;
+	uint64_t prev_end = dir_end;
+	for(uint64_t i = 0; i < n; i++) {
+		const uint8_t* e = data + MAGIC_GRAPH_V2_LEN + 8 * (1 + 3 * i);
+		uint64_t id = read_be64(e);
+		uint64_t off = read_be64(e + 8);
+		uint64_t l = read_be64(e + 16);
+
+		CHECK(id > prev_id && id < SECTION_COUNT);
+		CHECK(off % SECTION_ALIGN == 0);
+		CHECK(off >= prev_end && off + l <= len);
+
+		if(id < SECTION_COUNT)
+			exists[id] = true;
+		prev_id = id;
+		prev_end = off + l;
+	}
+
+	// the sections, which the reader requires
+	CHECK(exists[SECTION_GRAMMAR]);
+	CHECK(exists[SECTION_MATRIX]);
+	CHECK(exists[SECTION_LABELS] || exists[SECTION_LABELS_PEF]);
+	CHECK(exists[SECTION_EDGE_IFS]);
+	CHECK(exists[SECTION_IFS_TABLE]);
+	CHECK(exists[SECTION_IFS]);
+	CHECK(exists[SECTION_RULES_TABLE]);
+	CHECK(exists[SECTION_RULES]);
+	CHECK(exists[SECTION_DICT]);
+}
+
+int main() {
+	TestGraph t;
+	if(test_graph_init(&t, NODES, LABELS, EDGES, NULL, NULL) < 0) {
+		fprintf(stderr, "failed to compress the graph\n");
+		return EXIT_FAILURE;
+	}
+
+	size_t len;
+	uint8_t* data = read_file(t.path, &len);
+	if(!data) {
+		perror(t.path);
+		return EXIT_FAILURE;
+	}
+
+	check_sections(data, len);
+
+	// every node and label is found again
+	char name[32];
+	for(size_t i = 0; i < NODES; i++) {
+		char* s = cgraphr_extract_node(t.g, t.nodes[i], NULL);
+		snprintf(name, sizeof(name), "n%zu", i);
+		CHECK(s && strcmp(s, name) == 0);
+		free(s);
+	}
+	for(size_t i = 0; i < LABELS; i++)
+		CHECK(t.labels[i] >= 0);
+
+	test_graph_queries(&t, NULL);
+
+	// the same graph from the buffer
+	TestGraph b = t;
+	b.g = cgraphr_init_buffer(data, len);
+	if(CHECK(b.g != NULL)) {
+		CHECK(cgraphr_node_count(b.g) == cgraphr_node_count(t.g));
+		test_graph_queries(&b, &t);
+		cgraphr_destroy(b.g);
+	}
+
+	free(data);
+	test_graph_destroy(&t);
+
+	return test_result("format");
+}
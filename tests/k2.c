@@ -0,0 +1,255 @@
+/**
+ * @file k2.c
+ * @author FR
+ *
+ * Test of the k2-trees, whose cells, rows, columns, regions and intersections of rows are compared with the matrix.
+ * Every matrix is written as a k2-tree with k = 2 and as a hybrid k2-tree,
+ * which are read from the file and decoded in memory.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <constants.h>
+#include <writer.h>
+#include <reader.h>
+#include <k2.h>
+#include <k2_writer.h>
+
+#include "common.h"
+
+#define MATRICES 5
+#define BATCH 8 // number of adjacent columns extracted together
+
+typedef struct {
+	size_t width; // columns
+	size_t height; // rows
+	size_t edges;
+	uint8_t* cells; // cells[row * width + column]
+} Matrix;
+
+// sparse and dense matrices, non-square matrices like the incidence matrix and a matrix with a single cell
+static void generate(Matrix* m, int kind, K2Edge** edges) {
+	static const size_t sizes[MATRICES][3] = {
+		{ 200, 200, 600 }, { 700, 300, 4000 }, { 64, 64, 2000 }, { 5, 3, 1 }, { 1000, 1000, 3000 }
+	};
+
+	m->width = sizes[kind][0];
+	m->height = sizes[kind][1];
+	m->cells = calloc(m->width * m->height, 1);
+	*edges = malloc(sizes[kind][2] * sizeof(**edges));
+
+	// the cells are set once, half of them near the diagonal
+	m->edges = 0;
+	for(size_t i = 0; i < sizes[kind][2]; i++) {
+		size_t p = test_random() % m->height;
+		size_t q = i % 2 ? test_random() % m->width : (p + test_random() % 16) % m->width;
+		if(m->cells[p * m->width + q])
+			continue;
+
+		m->cells[p * m->width + q] = 1;
+		(*edges)[m->edges].xval = q;
+		(*edges)[m->edges].yval = p;
+		m->edges++;
+	}
+}
+
+static void check_tree(K2Reader* k, const Matrix* m) {
+	if(!CHECK(k->width >= m->width && k->height >= m->height))
+		return;
+
+	for(size_t p = 0; p < m->height; p++)
+		for(size_t q = 0; q < m->width; q++)
+			CHECK(k2_get(k, p, q) == m->cells[p * m->width + q]);
+
+	// every row
+	K2Iterator it;
+	uint64_t v;
+	for(size_t p = 0; p < m->height; p++) {
+		k2_iter_init_row(k, p, &it);
+		for(size_t q = 0; q < m->width; q++)
+			if(m->cells[p * m->width + q])
+				CHECK(k2_iter_next(&it, &v) == 1 && v == q);
+		CHECK(k2_iter_next(&it, &v) != 1);
+	}
+
+	// every column, alone and in batches of adjacent columns
+	uint64_t* rows = malloc((BATCH + 1) * m->height * sizeof(*rows));
+	uint64_t* single = rows + BATCH * m->height;
+	size_t lens[BATCH];
+	uint64_t qs[BATCH];
+	for(size_t q = 0; q < m->width; q += BATCH) {
+		size_t n = 0;
+		for(; n < BATCH && q + n < m->width; n++)
+			qs[n] = q + n;
+
+		size_t all = k2_columns(k, qs, n, rows, m->height, lens);
+		size_t count = 0;
+		for(size_t i = 0; i < n; i++) {
+			uint64_t* col = rows + i * m->height;
+			size_t len = 0;
+			for(size_t p = 0; p < m->height; p++) {
+				if(m->cells[p * m->width + q + i]) {
+					CHECK(len < lens[i] && col[len] == p);
+					len++;
+				}
+			}
+			CHECK(lens[i] == len);
+			count += len;
+
+			CHECK(k2_column(k, q + i, single, m->height) == len && memcmp(single, col, len * sizeof(*col)) == 0);
+		}
+		CHECK(all == count);
+	}
+
+	free(rows);
+}
+
+static void check_regions(K2Reader* k, const Matrix* m) {
+	uint8_t* seen = calloc(m->width * m->height, 1);
+
+	for(int i = 0; i < 50; i++) {
+		// the whole matrix, single cells and random regions
+		size_t p1 = 0, p2 = m->height, q1 = 0, q2 = m->width;
+		if(i > 0) {
+			p1 = test_random() % m->height;
+			q1 = test_random() % m->width;
+			p2 = i % 5 == 0 ? p1 + 1 : p1 + 1 + test_random() % (m->height - p1);
+			q2 = i % 5 == 0 ? q1 + 1 : q1 + 1 + test_random() % (m->width - q1);
+		}
+
+		size_t expected = 0;
+		for(size_t p = p1; p < p2; p++)
+			for(size_t q = q1; q < q2; q++)
+				expected += m->cells[p * m->width + q];
+
+		// every cell of the region is returned once
+		K2RegionIterator it;
+		uint64_t p, q;
+		size_t n = 0;
+		k2_region_init(k, p1, p2, q1, q2, &it);
+		while(k2_region_next(&it, &p, &q) == 1) {
+			if(!CHECK(p >= p1 && p < p2 && q >= q1 && q < q2 && m->cells[p * m->width + q] && !seen[p * m->width + q]))
+				break;
+
+			seen[p * m->width + q] = 1;
+			n++;
+		}
+		CHECK(n == expected);
+
+		memset(seen, 0, m->width * m->height);
+	}
+
+	free(seen);
+}
+
+static void check_rows(K2Reader* k, const Matrix* m) {
+	uint64_t rows[4];
+
+	for(int i = 0; i < 200; i++) {
+		// sorted distinct rows, the neighbors of the diagonal share columns often
+		int n = 1 + i % 4;
+		rows[0] = test_random() % m->height;
+		int len = 1;
+		for(int j = 1; j < n; j++) {
+			uint64_t r = i % 2 ? rows[len - 1] + 1 + test_random() % 4 : test_random() % m->height;
+			if(r >= m->height || r <= rows[len - 1])
+				continue;
+			rows[len++] = r;
+		}
+
+		K2RowsIterator it;
+		if(!CHECK(k2_rows_init(k, rows, len, &it) == 0))
+			continue;
+
+		uint64_t v;
+		bool equal = true;
+		for(size_t q = 0; q < m->width && equal; q++) {
+			bool all = true;
+			for(int j = 0; j < len; j++)
+				all = all && m->cells[rows[j] * m->width + q];
+
+			if(all)
+				equal = CHECK(k2_rows_next(&it, &v) == 1 && v == q);
+		}
+
+		if(!equal || !CHECK(k2_rows_next(&it, &v) != 1))
+			k2_rows_finish(&it);
+	}
+}
+
+int main() {
+	char* path = test_tmpfile();
+	if(!path)
+		return EXIT_FAILURE;
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	BitsequenceParams params = { .factor = 4 };
+
+	Matrix m[MATRICES];
+	FileOff off[MATRICES][2];
+	for(int i = 0; i < MATRICES; i++) {
+		K2Edge* edges;
+		generate(&m[i], i, &edges);
+
+		// the writer reorders and changes the edges, so each tree gets a copy
+		K2Edge* copy = malloc(m[i].edges * sizeof(*copy));
+		for(int hybrid = 0; hybrid <= 1; hybrid++) {
+			while(bitwriter_len(&w) % (8 * SECTION_ALIGN) != 0)
+				bitwriter_write_bit(&w, 0);
+
+			memcpy(copy, edges, m[i].edges * sizeof(*copy));
+			off[i][hybrid] = bitwriter_len(&w) / 8;
+			if(k2_write(m[i].width, m[i].height, copy, m[i].edges, hybrid, &w, &params) < 0) {
+				fprintf(stderr, "failed to write the k2-tree\n");
+				return EXIT_FAILURE;
+			}
+		}
+
+		free(copy);
+		free(edges);
+	}
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	for(int in_memory = 0; in_memory <= 1; in_memory++) {
+		FileReader* fr = filereader_init(path, NULL);
+		if(!fr) {
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		fr->in_memory = in_memory;
+
+		for(int i = 0; i < MATRICES; i++) {
+			for(int hybrid = 0; hybrid <= 1; hybrid++) {
+				Reader r;
+				reader_initf(fr, &r, off[i][hybrid]);
+				K2Reader* k = k2_init(&r);
+				if(!CHECK(k != NULL))
+					continue;
+
+				check_tree(k, &m[i]);
+				check_regions(k, &m[i]);
+				check_rows(k, &m[i]);
+				k2_destroy(k);
+			}
+		}
+
+		filereader_close(fr);
+	}
+
+	for(int i = 0; i < MATRICES; i++)
+		free(m[i].cells);
+
+	unlink(path);
+	free(path);
+
+	return test_result("k2");
+}
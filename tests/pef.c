@@ -0,0 +1,136 @@
+/**
+ * @file pef.c
+ * @author FR
+ *
+ * Test of the partitioned Elias-Fano lists, whose random access, successor and iterator of the labels
+ * are compared with the Elias-Fano lists of the same elements and with the elements of the list.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <constants.h>
+#include <writer.h>
+#include <reader.h>
+#include <eliasfano.h>
+#include <eliasfano_list.h>
+#include <pef.h>
+#include <pef_list.h>
+
+#include "common.h"
+
+static void check_list(PEFReader* p, EliasFanoReader* e, const uint64_t* list, size_t n) {
+	if(!CHECK(pef_len(p) == n && e->n == n))
+		return;
+
+	for(size_t i = 0; i < n; i++)
+		CHECK(pef_get(p, i) == list[i] && pef_get(p, i) == eliasfano_get(e, i));
+
+	// the successor of each element, its predecessor and successor value and the value after the last element
+	EliasFanoCursor c;
+	for(size_t i = 0; i <= n; i++) {
+		uint64_t x = i < n ? list[i] : list[n - 1] + 1;
+		for(uint64_t y = x > 0 ? x - 1 : x; y <= x + 1; y++) {
+			uint64_t k = eliasfano_successor(e, y, &c) ? c.i : n;
+			CHECK(pef_successor(p, y) == k);
+			CHECK(k == n || (list[k] >= y && (k == 0 || list[k - 1] < y)));
+		}
+	}
+
+	// the labels are followed by the non-terminals, which start at the last quarter of the list
+	uint64_t first_nt = list[3 * n / 4];
+	for(size_t i = 0; i < n; i += 1 + n / 50) {
+		for(uint64_t label = list[i]; label <= list[i] + 1 && label < first_nt; label++) {
+			PEFIterator pit;
+			EliasFanoIterator eit;
+			pef_iter(p, label, first_nt, &pit);
+			eliasfano_iter(e, label, first_nt, &eit);
+
+			uint64_t v1, v2;
+			int res;
+			do {
+				res = pef_iter_next(&pit, &v1);
+				CHECK(res == eliasfano_iter_next(&eit, &v2));
+				if(res == 1)
+					CHECK(v1 == v2 && (list[v1] == label || list[v1] >= first_nt));
+			} while(res == 1);
+		}
+	}
+}
+
+int main() {
+	char* path = test_tmpfile();
+	if(!path)
+		return EXIT_FAILURE;
+
+	BitWriter w;
+	if(bitwriter_init(&w, path) < 0) {
+		perror(path);
+		return EXIT_FAILURE;
+	}
+
+	BitsequenceParams params = { .factor = 4 };
+
+	uint64_t* lists[TEST_LISTS];
+	size_t lens[TEST_LISTS];
+	FileOff off_pef[TEST_LISTS], off_ef[TEST_LISTS];
+	for(int i = 0; i < TEST_LISTS; i++) {
+		lists[i] = test_list(i, &lens[i]);
+
+		while(bitwriter_len(&w) % (8 * SECTION_ALIGN) != 0)
+			bitwriter_write_bit(&w, 0);
+
+		off_pef[i] = bitwriter_len(&w) / 8;
+		if(pef_write(lists[i], lens[i], &w) < 0) {
+			fprintf(stderr, "failed to write the list\n");
+			return EXIT_FAILURE;
+		}
+
+		while(bitwriter_len(&w) % (8 * SECTION_ALIGN) != 0)
+			bitwriter_write_bit(&w, 0);
+
+		off_ef[i] = bitwriter_len(&w) / 8;
+		if(eliasfano_write(lists[i], lens[i], &w, &params) < 0) {
+			fprintf(stderr, "failed to write the list\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	bitwriter_write_bits(&w, 0, 64); // padding
+	bitwriter_close(&w);
+
+	for(int in_memory = 0; in_memory <= 1; in_memory++) {
+		FileReader* fr = filereader_init(path, NULL);
+		if(!fr) {
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		fr->in_memory = in_memory;
+
+		for(int i = 0; i < TEST_LISTS; i++) {
+			Reader r;
+			reader_initf(fr, &r, off_pef[i]);
+			PEFReader* p = pef_init(&r);
+			reader_initf(fr, &r, off_ef[i]);
+			EliasFanoReader* e = eliasfano_init(&r);
+
+			if(CHECK(p != NULL && e != NULL))
+				check_list(p, e, lists[i], lens[i]);
+
+			if(p)
+				pef_destroy(p);
+			if(e)
+				eliasfano_destroy(e);
+		}
+
+		filereader_close(fr);
+	}
+
+	for(int i = 0; i < TEST_LISTS; i++)
+		free(lists[i]);
+
+	unlink(path);
+	free(path);
+
+	return test_result("pef");
+}
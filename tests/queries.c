@@ -0,0 +1,78 @@
+/**
+ * @file queries.c
+ * @author FR
+ *
+ * Test of the optional structures of the compressed graph, which must not change the results of the queries.
+ * The graph is compressed with the defaults and with each structure, and the queries of both graphs
+ * are compared with each other and with the generated edges.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "common.h"
+
+#define NODES 300
+#define LABELS 6
+#define EDGES 3000
+
+typedef struct {
+	const char* name;
+	TestParams p;
+} Variant;
+
+static void edge_nodes(CGraphCParams* p) {
+	p->edge_nodes = true;
+}
+
+static void nt_summary(CGraphCParams* p) {
+	p->nt_summary = true;
+}
+
+static void nt_summary_edge_nodes(CGraphCParams* p) {
+	p->nt_summary = true;
+	p->edge_nodes = true;
+}
+
+static void label_postings(CGraphCParams* p) {
+	p->label_postings = true;
+}
+
+static void all(CGraphCParams* p) {
+	p->edge_nodes = true;
+	p->nt_summary = true;
+	p->label_postings = true;
+	p->degrees = true;
+}
+
+static const Variant variants[] = {
+	{ "edge nodes", edge_nodes },
+	{ "NT summaries", nt_summary },
+	{ "NT summaries and edge nodes", nt_summary_edge_nodes },
+	{ "label postings", label_postings },
+	{ "all structures", all },
+};
+
+int main() {
+	TestGraph base;
+	if(test_graph_init(&base, NODES, LABELS, EDGES, NULL, NULL) < 0) {
+		fprintf(stderr, "failed to compress the graph\n");
+		return EXIT_FAILURE;
+	}
+
+	test_graph_queries(&base, NULL);
+
+	for(size_t i = 0; i < sizeof(variants) / sizeof(*variants); i++) {
+		TestGraph t;
+		if(!CHECK(test_graph_init(&t, NODES, LABELS, EDGES, variants[i].p, NULL) == 0)) {
+			fprintf(stderr, "failed to compress the graph with %s\n", variants[i].name);
+			continue;
+		}
+
+		test_graph_queries(&t, &base);
+		test_graph_destroy(&t);
+	}
+
+	test_graph_destroy(&base);
+
+	return test_result("queries");
+}